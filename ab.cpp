@@ -6,11 +6,48 @@
 
 constexpr pos_t size = 8;
 
+// in the form used by the commands, {color}{position} or {color}p for a pass
+std::string format_move(Move m) {
+    std::string s = m.color == BLACK ? "b" : "w";
+    return s + (m.is_pass ? "p" : std::to_string(m.position + 1));
+}
+
 void configure_parser(cli::Parser &parser) {
     parser.set_optional<int>("a", "alpha", -size, "Initial alpha value");
     parser.set_optional<int>("b", "beta", size, "Initial beta value");
     parser.set_optional<int>("g", "guess", -100000,
-                             "Minimax guess. Overrides alpha and beta options.");
+                             "Minimax guess used for the first MTD(f) probe. Overrides --eval.");
+    parser.set_optional<std::string>("e", "eval", "influence",
+                                     "Static evaluation at the depth cutoff and for the first "
+                                     "guess: minimax, influence, liberties or table");
+    parser.set_optional<std::string>("t", "eval-table", "",
+                                     "Evaluation table written by train_eval, implies --eval table");
+    parser.set_optional<std::string>("w", "weights", "",
+                                     "Move ordering weights written by train_ordering");
+    parser.set_optional<int>("q", "quiescence", 0,
+                             "Plies of captures and ataris searched past the depth cutoff");
+    parser.set_optional<int>("j", "threads", 1, "Number of lazy SMP search threads");
+    parser.set_optional<bool>("p", "parallel-probes", false,
+                              "Use the threads to probe several MTD(f) thresholds at once");
+    parser.set_optional<std::string>("c", "checkpoint", "",
+                                     "File to checkpoint the search to, for --resume");
+    parser.set_optional<int>("i", "checkpoint-interval", 600, "Seconds between checkpoints");
+    parser.set_optional<std::string>("r", "resume", "",
+                                     "Checkpoint to resume the search from. Checkpoints go back "
+                                     "to the same file unless --checkpoint is given.");
+    parser.set_optional<int>("n", "nodes", 0, "Stop searching after about this many nodes");
+    parser.set_optional<double>("s", "seconds", 0, "Stop searching after this many seconds");
+    parser.set_optional<int>("m", "max-cutoff", 0, "Deepest iterative deepening cutoff to search");
+    parser.set_optional<std::string>("x", "tablebase", "",
+                                     "Tablebase written by gen_tablebase, probed by the search");
+    parser.set_optional<std::string>("k", "book", "",
+                                     "Opening book written by gen_book, for the first plies");
+    parser.set_optional<int>("d", "endgame", EndgameSolver<size>().max_empty,
+                             "Hand positions with up to this many empty cells to the endgame "
+                             "solver, 0 for none");
+    parser.set_optional<int>("o", "ponder", 0,
+                             "After a solve, search the positions after this many moves in the "
+                             "background until the next command");
     parser.set_optional<std::vector<std::string>>(
         "", "state", std::vector<std::string>(),
         "Moves in the form {color}{position}, where color is b or w");
@@ -21,8 +58,55 @@ int main(int argc, char **argv) {
     configure_parser(parser);
     parser.run_and_exit_if_error();
 
+    std::string weights = parser.get<std::string>("w");
+    if (!weights.empty() && !OrderingWeights<size>::global.load(weights)) {
+        std::cout << "could not load ordering weights from " << weights << std::endl;
+        return 1;
+    }
+
     using Impl = NewickTree<size, Metrics<size, conjectures::All<size, PV<size>>>>;
     IterativeDeepening<size, AlphaBeta, Impl> ab;
+    ab.impl.impl.quiescence_depth = parser.get<int>("q");
+    ab.threads = std::max(1, parser.get<int>("j"));
+    ab.parallel_probes = parser.get<bool>("p");
+    ab.configure_helper = [](auto &helper) {
+        helper.impl.write_file = false;
+        helper.impl.tree_depth_cutoff = 0;
+    };
+    if (parser.get<int>("g") != -100000)
+        ab.guess = parser.get<int>("g");
+    std::string eval_table = parser.get<std::string>("t");
+    if (!eval_table.empty()) {
+        if (!ab.impl.impl.evaluator.table.load(eval_table)) {
+            std::cout << "could not load evaluation table from " << eval_table << std::endl;
+            return 1;
+        }
+        ab.impl.impl.evaluator.kind = Evaluator<size>::TABLE;
+    } else if (!ab.impl.impl.evaluator.set_kind(parser.get<std::string>("e"))) {
+        std::cout << "unknown evaluator " << parser.get<std::string>("e") << std::endl;
+        return 1;
+    }
+
+    Tablebase<size> tablebase;
+    std::string tablebase_file = parser.get<std::string>("x");
+    if (!tablebase_file.empty()) {
+        if (!tablebase.load(tablebase_file)) {
+            std::cout << "could not load tablebase from " << tablebase_file << std::endl;
+            return 1;
+        }
+        ab.impl.tablebase = &tablebase;
+    }
+    ab.impl.endgame.max_empty = std::max(0, parser.get<int>("d"));
+
+    OpeningBook<size> book;
+    std::string book_file = parser.get<std::string>("k");
+    if (!book_file.empty()) {
+        if (!book.load(book_file)) {
+            std::cout << "could not load opening book from " << book_file << std::endl;
+            return 1;
+        }
+        ab.book = &book;
+    }
 
     /*ab.callback = [&](auto val) {
         std::cout << "cutoff=" << ab.impl.impl.cutoff << "\tminimax=" << val.minimax
@@ -35,57 +119,144 @@ int main(int argc, char **argv) {
         std::cout << "invalid bounds!" << std::endl;
         return 0;
     }
-    bool searching = false;
+    std::string resume = parser.get<std::string>("r");
+    ab.checkpoint_file = parser.get<std::string>("c");
+    if (ab.checkpoint_file.empty())
+        ab.checkpoint_file = resume;
+    ab.checkpoint_interval = std::chrono::seconds(parser.get<int>("i"));
+    ab.limits.nodes = std::max(0, parser.get<int>("n"));
+    ab.limits.time = std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+        std::chrono::duration<double>(std::max(0.0, parser.get<double>("s"))));
+    ab.limits.max_cutoff = std::max(0, parser.get<int>("m"));
+
+    size_t ponder = std::max(0, parser.get<int>("o"));
+
+    // busy stays set while the search thread goes on pondering after the result
+    std::atomic<bool> searching{false}, busy{false};
+    // runs one of the commands r (solve), m (solve every move) or t (decide value >= k). the
+    // next query may come as soon as the result is printed, so the flag is cleared first.
+    auto start_search = [&](State<size> root, char command, int k) {
+        searching = busy = true;
+        std::thread([=, &ab, &searching, &busy]() mutable {
+            bool solved = false;
+            std::stringstream result;
+            try {
+                std::cout << "Searching " << root.board << std::endl;
+                ab.impl.node_count = 0;
+                result << "\n";
+                if (command == 'm') {
+                    // a ? marks a value cut short by a limit
+                    for (auto &m : ab.search_moves(root, alpha, beta)) {
+                        result << format_move(m.move) << "\t" << m.value.minimax
+                               << (m.value.exact ? "" : "?") << "\t";
+                        for (size_t i = 0; i < m.pv.size(); i++)
+                            result << (i ? " " : "") << format_move(m.pv[i]);
+                        result << "\n";
+                    }
+                } else if (command == 't') {
+                    auto at_least = ab.solve_at_least(root, k);
+                    result << root.board << " minimax ";
+                    if (!at_least)
+                        result << "undecided, stopped in [" << ab.lower_bound << ", "
+                               << ab.upper_bound << "]\n";
+                    else
+                        result << (*at_least ? ">= " : "< ") << k << "\n";
+                } else {
+                    auto node = ab.search(root, alpha, beta);
+                    solved = node.exact;
+                    if (node.exact)
+                        result << root.board << " minimax " << node.minimax << "\n";
+                    else
+                        result << root.board << " stopped, minimax in [" << ab.lower_bound
+                               << ", " << ab.upper_bound << "], best guess " << node.minimax
+                               << "\n";
+                }
+                result << "> ";
+            } catch (...) {
+            }
+            ab.limits.stop = false;
+            searching = false;
+            std::cout << result.str() << std::flush;
+            if (solved && ponder)
+                ab.ponder(root, ponder);
+            busy = false;
+        }).detach();
+    };
+    auto stop_pondering = [&] {
+        if (!busy || searching)
+            return;
+        ab.limits.stop = true;
+        while (busy)
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        ab.limits.stop = false;
+    };
+    if (!resume.empty()) {
+        State<size> root;
+        if (!ab.resume(resume, root)) {
+            std::cout << "could not resume from " << resume << std::endl;
+            return 1;
+        }
+        start_search(root, 'r', 0);
+    }
     while (true) {
         try {
             std::cout << "> ";
             std::string line;
             if (!std::getline(std::cin, line))
                 break;
-            if (line[0] == 'r') {
+            if (line[0] == 'r' || line[0] == 'm' || line[0] == 't') {
                 if (searching) {
                     std::cout << "You must halt the current search first." << std::endl;
                     continue;
                 }
-                std::thread([=, &ab, &searching]() {
-                    try {
-                        State<size> root;
-                        std::istringstream iss(line.substr(1));
-                        std::string move;
-                        while (iss >> move) {
-                            char player = tolower(move[0]);
-                            int pos = std::stoi(move.substr(1));
-                            root.play(Move(player == 'b' ? BLACK : WHITE, pos - 1));
-                        }
-                        std::cout << "Searching " << root.board << std::endl;
-                        ab.impl.node_count = 0;
-                        auto node = ab.search(root, alpha, beta);
-                        if (!ab.impl.quit)
-                            std::cout << "\n"
-                                      << root.board << " minimax " << node.minimax << "\n> "
-                                      << std::flush;
-                    } catch (...) {
-                    }
-                    ab.impl.quit = false;
-                    searching = false;
-                }).detach();
-                searching = true;
+                stop_pondering();
+                State<size> root;
+                std::istringstream iss(line.substr(1));
+                int k = 0;
+                if (line[0] == 't' && !(iss >> k)) {
+                    std::cout << "usage: t k move1 move2 ..." << std::endl;
+                    continue;
+                }
+                std::string move;
+                while (iss >> move) {
+                    char player = tolower(move[0]);
+                    int pos = std::stoi(move.substr(1));
+                    root.play(Move(player == 'b' ? BLACK : WHITE, pos - 1));
+                }
+                start_search(root, line[0], k);
             } else if (line[0] == 'h') {
                 if (!searching) {
                     std::cout << "No search to halt." << std::endl;
                 } else {
                     std::cout << "Halting..." << std::endl;
-                    ab.impl.quit = true;
+                    ab.limits.stop = true;
+                }
+            } else if (line[0] == 'c') {
+                if (searching) {
+                    std::cout << "You must halt the current search first." << std::endl;
+                    continue;
                 }
+                stop_pondering();
+                ab.forget();
             } else if (line[0] == 'i') {
+                if (busy && !searching)
+                    std::cout << "pondering" << std::endl;
                 std::cout << "nodes searched=" << ab.impl.impl.num_nodes << std::endl;
+                std::cout << "quiescence nodes=" << ab.impl.impl.quiescence_nodes << std::endl;
+                std::cout << "MTD(f) probes=" << ab.probe_count << std::endl;
                 std::cout << "best guess=" << ab.last_result.minimax << std::endl;
+                if (ab.impl.cutoff_count)
+                    std::cout << "first move cutoffs=" << ab.impl.first_move_cutoff_count << "/"
+                              << ab.impl.cutoff_count << std::endl;
             } else {
                 std::cout << "commands:\n"
                              "\t?\t\t\t :: show this help\n"
                              "\tr move1 move2 ...\t :: run search\n"
+                             "\tm move1 move2 ...\t :: solve every move after these\n"
+                             "\tt k move1 move2 ...\t :: only decide whether minimax >= k\n"
                              "\th\t\t\t :: halt current search\n"
-                             "\ti\t\t\t :: print info about current search\n";
+                             "\ti\t\t\t :: print info about current search\n"
+                             "\tc\t\t\t :: clear what earlier searches learned\n";
             }
         } catch (...) {
         }
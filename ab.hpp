@@ -1,17 +1,30 @@
 #pragma once
 
+#include "bounds.hpp"
+#include "evaluate.hpp"
 #include "lgo.hpp"
 #include "player.hpp"
+#include "book.hpp"
+#include "endgame.hpp"
+#include "tablebase.hpp"
 #include <algorithm>
 #include <array>
+#include <atomic>
+#include <chrono>
 #include <climits>
+#include <condition_variable>
+#include <cstdio>
 #include <cstdlib>
+#include <cstring>
 #include <ctime>
 #include <fstream>
 #include <functional>
 #include <memory>
+#include <mutex>
 #include <set>
 #include <sstream>
+#include <thread>
+#include <tuple>
 #include <unordered_map>
 
 enum class NodeType { NIL, PV, MIN, MAX };
@@ -47,8 +60,33 @@ template <pos_t size> struct Minimax {
                  const return_t &value, bool terminal) const {}
     void pre_update(Move move, minimax_t &alpha, minimax_t &beta, return_t &parent, size_t depth,
                     size_t index) const {}
+    // with a null window alpha == beta - 1, so comparing against one bound folds into a test of
+    // which side of the threshold a value falls on
+    template <bool NullWindow = false>
     void update(Move move, minimax_t &alpha, minimax_t &beta, return_t &parent,
                 const return_t &child) const {
+        if (NullWindow) {
+            if (move.color == BLACK) {
+                if (child.minimax == alpha || parent.minimax == child.minimax)
+                    parent.exact |= child.exact;
+                if (child.minimax >= beta || parent.minimax >= beta ||
+                    child.minimax > parent.minimax)
+                    parent.exact = child.exact;
+                parent.minimax = std::max(parent.minimax, child.minimax);
+                if (parent.minimax >= beta)
+                    alpha = parent.minimax;
+            } else {
+                if (child.minimax == beta || parent.minimax == child.minimax)
+                    parent.exact |= child.exact;
+                if (child.minimax <= alpha || parent.minimax <= alpha ||
+                    child.minimax < parent.minimax)
+                    parent.exact = child.exact;
+                parent.minimax = std::min(parent.minimax, child.minimax);
+                if (parent.minimax <= alpha)
+                    beta = parent.minimax;
+            }
+            return;
+        }
         if (move.color == BLACK) {
             if (child.minimax == alpha || parent.minimax == child.minimax)
                 parent.exact |= child.exact;
@@ -107,10 +145,11 @@ template <pos_t size, typename Impl = Minimax<size>> struct PV : Impl {
     };
     typedef Node return_t;
     typedef typename Impl::minimax_t minimax_t;
+    template <bool NullWindow = false>
     void update(Move move, minimax_t &alpha, minimax_t &beta, return_t &parent,
                 return_t &child) const {
         child.move = move;
-        Impl::update(move, alpha, beta, parent, child);
+        Impl::template update<NullWindow>(move, alpha, beta, parent, child);
         if (child.type == NodeType::PV)
             parent.child = std::make_shared<Node>(child);
     }
@@ -129,41 +168,171 @@ size_t murmur(size_t key) {
     return key;
 }
 
+// a flag raised from another thread to abandon a search. tokens form a chain, so cancelling a
+// search also cancels everything searched on its behalf.
+struct CancelToken {
+    std::atomic<bool> flag{false};
+    const CancelToken *parent = nullptr;
+
+    bool cancelled() const {
+        for (const CancelToken *t = this; t; t = t->parent)
+            if (t->flag.load(std::memory_order_relaxed))
+                return true;
+        return false;
+    }
+};
+
+// budgets for a search. any thread may raise stop. the node and time budgets are checked by the
+// searchers once every NODE_BATCH nodes, so the hot path only reads atomic flags.
+struct SearchLimits {
+    static constexpr size_t NODE_BATCH = 1024;
+    size_t nodes = 0;                            // 0 for no limit
+    std::chrono::steady_clock::duration time{0}; // 0 for no limit
+    size_t max_cutoff = 0;                       // deepest iterative deepening cutoff, 0 for none
+    std::atomic<bool> stop{false};
+
+    std::atomic<size_t> nodes_searched{0};
+    std::atomic<bool> expired{false};
+    std::chrono::steady_clock::time_point start;
+
+    // starts the budgets, stop is left to whoever raised it
+    void begin() {
+        nodes_searched = 0;
+        expired = false;
+        start = std::chrono::steady_clock::now();
+    }
+    bool hit() const {
+        return stop.load(std::memory_order_relaxed) || expired.load(std::memory_order_relaxed);
+    }
+    void tick(size_t batch = NODE_BATCH) {
+        size_t n = nodes_searched.fetch_add(batch, std::memory_order_relaxed) + batch;
+        if ((nodes && n >= nodes) ||
+            (time.count() && std::chrono::steady_clock::now() - start >= time))
+            expired = true;
+    }
+};
+
 template <pos_t size, typename Impl = Minimax<size>> struct AlphaBeta {
     std::vector<std::vector<Move>> moves;
     Impl impl;
     static constexpr size_t ORDER_TABLE_SIZE = 1 << 22;
-    std::vector<std::vector<std::tuple<int, size_t, Move>>> order_table =
-        std::vector<std::vector<std::tuple<int, size_t, Move>>>(ORDER_TABLE_SIZE);
+    // allocated by the first search which uses it
+    std::vector<std::vector<std::tuple<int, size_t, Move>>> order_table;
+    bool use_order_table = true;
     size_t node_count = 0;
-    bool quit = false;
+    size_t cutoff_count = 0, first_move_cutoff_count = 0; // to measure move ordering quality
+    std::atomic<bool> quit{false};
+    const CancelToken *cancel = nullptr;
+    SearchLimits *limits = nullptr;
+    bool vary_order = false; // perturb move ordering, used by lazy SMP helpers
+    std::minstd_rand order_rng;
+    const Tablebase<size> *tablebase = nullptr; // exact values of positions without captures
+    EndgameSolver<size> endgame;                // exact values of positions with few empty cells
+
+    typedef typename Impl::minimax_t minimax_t;
 
-    typename Impl::return_t search(State<size> &state,
-                                   typename Impl::minimax_t alpha = Impl::alpha_init(),
-                                   typename Impl::minimax_t beta = Impl::beta_init(),
-                                   size_t depth = 0) {
+    typename Impl::return_t search(State<size> &state, minimax_t alpha = Impl::alpha_init(),
+                                   minimax_t beta = Impl::beta_init(), size_t depth = 0) {
+        if (use_order_table && order_table.empty())
+            order_table.resize(ORDER_TABLE_SIZE);
+        // every MTD(f) probe is a null window, which gets its own specialized path
+        if (beta == alpha + 1)
+            return search_window<true>(state, alpha, beta, depth);
+        return search_window<false>(state, alpha, beta, depth);
+    }
+
+    bool halted() const {
+        return quit || (cancel && cancel->cancelled()) || (limits && limits->hit());
+    }
+
+    bool probe_tablebase(const State<size> &state, typename Impl::return_t &node) const {
+        optional<int> value = tablebase->probe(state);
+        if (!value)
+            return false;
+        node.minimax = *value;
+        node.exact = true;
+        return true;
+    }
+    bool solve_endgame(const State<size> &state, minimax_t alpha, minimax_t beta,
+                       typename Impl::return_t &node) {
+        optional<int> value = endgame.solve(state, alpha, beta);
+        if (!value)
+            return false;
+        node.minimax = *value;
+        node.exact = true;
+        return true;
+    }
+
+    // a null window has no room for a PV node, so a value is classified by the threshold alone
+    template <bool NullWindow> static NodeType node_type(minimax_t value, minimax_t ab, minimax_t bb) {
+        if (NullWindow)
+            return value >= bb ? NodeType::MAX : NodeType::MIN;
+        if (value > ab && value < bb)
+            return NodeType::PV;
+        if (value >= bb)
+            return NodeType::MAX;
+        return NodeType::MIN;
+    }
+
+    template <bool NullWindow>
+    typename Impl::return_t search_window(State<size> &state, minimax_t alpha, minimax_t beta,
+                                          size_t depth) {
         assert(alpha != beta);
+        assert(!NullWindow || beta == alpha + 1);
 
-        typename Impl::minimax_t ab = alpha, bb = beta;
+        // with a null window the original bounds are beta - 1 and beta, only the threshold is kept
+        const minimax_t ab = NullWindow ? 0 : alpha, bb = beta;
         node_count++;
+        if (limits && node_count % SearchLimits::NODE_BATCH == 0)
+            limits->tick();
         bool terminal = false;
 
         // passing sets bounds
-        if (state.to_play == BLACK && state.game_state == State<size>::PASS)
-            alpha = std::max(alpha, state.board.minimax());
-        if (state.to_play == WHITE && state.game_state == State<size>::PASS)
-            beta = std::min(beta, state.board.minimax());
+        if (state.game_state == State<size>::PASS) {
+            int minimax = state.board.minimax();
+            if (NullWindow) {
+                if (state.to_play == BLACK && minimax >= beta)
+                    alpha = minimax;
+                if (state.to_play == WHITE && minimax <= alpha)
+                    beta = minimax;
+            } else {
+                if (state.to_play == BLACK)
+                    alpha = std::max(alpha, minimax);
+                if (state.to_play == WHITE)
+                    beta = std::min(beta, minimax);
+            }
+        }
 
         auto parent = impl.init_node(state, alpha, beta, depth, terminal);
-        if (quit)
-            return parent;
+        // a halted search unwinds through the terminal path so every layer sees a balanced exit,
+        // with inexact values that the transposition table will not keep
+        if (halted()) {
+            parent.exact = false;
+            terminal = true;
+        }
+        // a tablebase value is exact, so it also replaces a guess at the depth cutoff
+        else if (tablebase && (!terminal || !parent.exact) && probe_tablebase(state, parent)) {
+            terminal = true;
+        } else if ((!terminal || !parent.exact) && endgame.applies(state) &&
+                   solve_endgame(state, alpha, beta, parent)) {
+            terminal = true;
+        }
+        // proven bounds on the final score cut without expanding the node
+        else if (!terminal) {
+            int lower = StaticBounds<size>::lower(state.board);
+            if (lower >= beta) {
+                parent.minimax = lower;
+                terminal = true;
+            } else {
+                int upper = StaticBounds<size>::upper(state.board);
+                if (upper <= alpha) {
+                    parent.minimax = upper;
+                    terminal = true;
+                }
+            }
+        }
         if (terminal) {
-            if (parent.minimax > ab && parent.minimax < bb)
-                parent.type = NodeType::PV;
-            else if (parent.minimax >= bb)
-                parent.type = NodeType::MAX;
-            else if (parent.minimax <= ab)
-                parent.type = NodeType::MIN;
+            parent.type = node_type<NullWindow>(parent.minimax, ab, bb);
             impl.on_exit(state, alpha, beta, depth, parent, true);
             return parent;
         }
@@ -171,7 +340,7 @@ template <pos_t size, typename Impl = Minimax<size>> struct AlphaBeta {
         if (depth >= moves.size()) {
             while (depth >= moves.size()) {
                 moves.emplace_back();
-                moves[depth].reserve(size + 1); // max # moves is board size + pass
+                moves.back().reserve(size + 1); // max # moves is board size + pass
             }
         } else
             moves[depth].clear();
@@ -179,43 +348,58 @@ template <pos_t size, typename Impl = Minimax<size>> struct AlphaBeta {
         bool all_exact = true;
         auto parent_inexact = parent;
         if (beta > alpha) {
-            auto &order =
-                order_table[(murmur(state.board.board) ^ murmur(depth)) % ORDER_TABLE_SIZE];
-            if (state.to_play == BLACK)
-                std::sort(order.begin(), order.end(), [](auto a, auto b) {
-                    return std::get<0>(a) == std::get<0>(b) ? std::get<1>(a) < std::get<1>(b)
-                                                            : std::get<0>(a) > std::get<0>(b);
-                });
-            else
-                std::sort(order.begin(), order.end(), [](auto a, auto b) {
-                    return std::get<0>(a) == std::get<0>(b) ? std::get<1>(a) < std::get<1>(b)
-                                                            : std::get<0>(a) < std::get<0>(b);
-                });
-            for (auto &p : order) {
-                moves[depth].emplace_back(std::get<2>(p));
+            if (use_order_table) {
+                auto &order =
+                    order_table[(murmur(state.board.board) ^ murmur(depth)) % ORDER_TABLE_SIZE];
+                if (state.to_play == BLACK)
+                    std::sort(order.begin(), order.end(), [](auto a, auto b) {
+                        return std::get<0>(a) == std::get<0>(b) ? std::get<1>(a) < std::get<1>(b)
+                                                                : std::get<0>(a) > std::get<0>(b);
+                    });
+                else
+                    std::sort(order.begin(), order.end(), [](auto a, auto b) {
+                        return std::get<0>(a) == std::get<0>(b) ? std::get<1>(a) < std::get<1>(b)
+                                                                : std::get<0>(a) < std::get<0>(b);
+                    });
+                for (auto &p : order) {
+                    moves[depth].emplace_back(std::get<2>(p));
+                }
+                order.clear();
             }
-            order.clear();
             impl.gen_moves(state, moves[depth]);
+            if (vary_order && moves[depth].size() > 1 && order_rng() % 4 == 0)
+                std::swap(moves[depth][0], moves[depth][1]);
             size_t index = 0;
             for (Move move : moves[depth]) {
                 impl.pre_update(move, alpha, beta, parent, depth, index);
                 state.play(move);
                 size_t size_before = node_count;
-                auto child = search(state, alpha, beta, depth + 1);
+                // children of a null window node see the same window, wide windows may narrow
+                auto child = NullWindow ? search_window<true>(state, alpha, beta, depth + 1)
+                                        : search(state, alpha, beta, depth + 1);
                 size_t subtree_size = node_count - size_before;
                 all_exact &= child.exact;
                 state.undo();
+                if (halted()) {
+                    all_exact = false;
+                    break;
+                }
                 if (child.exact) {
-                    impl.update(move, alpha, beta, parent, child);
-                    auto &order =
-                        order_table[(murmur(state.board.board) ^ murmur(depth)) % ORDER_TABLE_SIZE];
-                    order.emplace_back(child.minimax, subtree_size, move);
+                    impl.template update<NullWindow>(move, alpha, beta, parent, child);
+                    if (use_order_table) {
+                        auto &order = order_table[(murmur(state.board.board) ^ murmur(depth)) %
+                                                  ORDER_TABLE_SIZE];
+                        order.emplace_back(child.minimax, subtree_size, move);
+                    }
                 }
                 auto alpha_inexact = alpha;
                 auto beta_inexact = beta;
-                impl.update(move, alpha_inexact, beta_inexact, parent_inexact, child);
+                impl.template update<NullWindow>(move, alpha_inexact, beta_inexact, parent_inexact,
+                                                 child);
 
                 if (beta <= alpha && child.exact) {
+                    cutoff_count++;
+                    first_move_cutoff_count += index == 0;
                     all_exact = parent.exact;
                     break;
                 }
@@ -228,15 +412,14 @@ template <pos_t size, typename Impl = Minimax<size>> struct AlphaBeta {
             parent = parent_inexact;
         }
 
-        if (parent.minimax > ab && parent.minimax < bb)
-            parent.type = NodeType::PV;
-        else if (parent.minimax >= bb)
-            parent.type = NodeType::MAX;
-        else if (parent.minimax <= ab)
-            parent.type = NodeType::MIN;
+        parent.type = node_type<NullWindow>(parent.minimax, ab, bb);
         impl.on_exit(state, alpha, beta, depth, parent, false);
-        if (depth == 0)
+        if (depth == 0) {
+            // a warm table makes for many short probes, count what is left of the batch
+            if (limits)
+                limits->tick(node_count % SearchLimits::NODE_BATCH);
             node_count = 0;
+        }
         return parent;
     }
 };
@@ -253,8 +436,12 @@ template <pos_t size, typename T> struct TranspositionTable {
         bool valid = false;
     };
     static constexpr size_t SIZE = 1 << 16;
+    static constexpr size_t LOCKS = 1 << 10;
     StateHasher<size> hasher;
     Entry *table;
+    // set when several searchers use the table at once, entries are then guarded by striped locks
+    bool shared = false;
+    std::unique_ptr<std::mutex[]> locks = std::make_unique<std::mutex[]>(LOCKS);
 
     TranspositionTable() { table = new Entry[SIZE]; }
     void clear() {
@@ -262,11 +449,18 @@ template <pos_t size, typename T> struct TranspositionTable {
             table[i].valid = false;
     }
     ~TranspositionTable() { delete[] table; }
+    std::unique_lock<std::mutex> lock(size_t hash) {
+        std::unique_lock<std::mutex> l(locks[hash % SIZE % LOCKS], std::defer_lock);
+        if (shared)
+            l.lock();
+        return l;
+    }
     void insert(const State<size> &state, const T &val, size_t entry_score) {
         // don't bother with nodes that are not very useful
         if (!val.node.exact || entry_score < 100)
             return;
         size_t hash = hasher(state);
+        auto l = lock(hash);
         Entry &e = table[hash % SIZE];
         if (e.valid) {
             // replacement scheme
@@ -283,14 +477,17 @@ template <pos_t size, typename T> struct TranspositionTable {
         e.entry_score = entry_score;
         e.valid = true;
     }
-    T *lookup(const State<size> &state) {
+    // copies the entry for state into val, since another searcher may replace it at any time
+    bool lookup(const State<size> &state, T &val) {
         size_t hash = hasher(state);
+        auto l = lock(hash);
         Entry *e = &table[hash % SIZE];
         if (e->valid && e->hash == hash && e->board == state.board && e->to_play == state.to_play &&
             e->game_state == state.game_state && e->history == state.history) {
-            return &e->val;
+            val = e->val;
+            return true;
         }
-        return nullptr;
+        return false;
     }
 };
 
@@ -322,15 +519,48 @@ struct IterativeDeepening {
         typedef Node return_t;
         typedef typename Impl::minimax_t minimax_t;
 
-        TranspositionTable<size, TTEntry> tt;
-        TTEntry *entry = nullptr;
+        std::shared_ptr<TranspositionTable<size, TTEntry>> tt; // created by the first search
         size_t cutoff = 0;
         std::stack<size_t> size_before;
         size_t pnode_count = 0;
+        size_t quiescence_depth = 0; // plies of captures and ataris searched past the cutoff
+        size_t quiescence_nodes = 0;
+        Evaluator<size> evaluator; // scores the horizon and the first MTD(f) guess
 
         static constexpr minimax_t alpha_init() { return Impl::alpha_init(); }
         static constexpr minimax_t beta_init() { return Impl::beta_init(); }
 
+        // search only captures and ataris, so that the horizon does not fall in the middle of an
+        // exchange. the player to move may always stand pat on the static evaluation.
+        minimax_t quiesce(State<size> &state, minimax_t alpha, minimax_t beta, size_t plies) {
+            quiescence_nodes++;
+            minimax_t value = evaluator(state);
+            if (plies == 0 || state.terminal())
+                return value;
+            Cell color = state.to_play;
+            if (color == BLACK)
+                alpha = std::max(alpha, value);
+            else
+                beta = std::min(beta, value);
+            pos_t forcing = state.legal_moves(color) &
+                            (state.capturing_moves(color) | state.board.atari_set(color));
+            for (pos_t i = 0; i < size && alpha < beta; i++) {
+                if (!(forcing & (1 << i)))
+                    continue;
+                state.play(Move(color, i));
+                minimax_t child = quiesce(state, alpha, beta, plies - 1);
+                state.undo();
+                if (color == BLACK) {
+                    value = std::max(value, child);
+                    alpha = std::max(alpha, value);
+                } else {
+                    value = std::min(value, child);
+                    beta = std::min(beta, value);
+                }
+            }
+            return value;
+        }
+
         return_t init_node(State<size> &state, minimax_t &alpha, minimax_t &beta, size_t depth,
                            bool &terminal) {
             size_before.push(pnode_count);
@@ -341,23 +571,23 @@ struct IterativeDeepening {
 
             if (depth >= cutoff) { // hit max depth, return heuristic score
                 terminal = true;
-                return heuristic_score(state.board.minimax());
+                return heuristic_score(quiesce(state, alpha, beta, quiescence_depth));
             }
             if (state.terminal()) { // hit terminal state, return true score
                 terminal = true;
                 return true_score(state.board.minimax());
             }
             // hit true transposition table entry, return score
-            entry = tt.lookup(state);
-            if (entry && entry->node.exact) {
-                pnode_count += entry->score;
-                if (entry->node.type == NodeType::PV) {
+            TTEntry entry;
+            if (tt->lookup(state, entry) && entry.node.exact) {
+                pnode_count += entry.score;
+                if (entry.node.type == NodeType::PV) {
                     terminal = true;
-                    return entry->node;
-                } else if (entry->node.type == NodeType::MAX) {
-                    alpha = std::max(alpha, entry->node.minimax);
-                } else if (entry->node.type == NodeType::MIN) {
-                    beta = std::min(beta, entry->node.minimax);
+                    return entry.node;
+                } else if (entry.node.type == NodeType::MAX) {
+                    alpha = std::max(alpha, entry.node.minimax);
+                } else if (entry.node.type == NodeType::MIN) {
+                    beta = std::min(beta, entry.node.minimax);
                 }
             }
             return true_score(state.to_play == BLACK ? alpha : beta);
@@ -367,45 +597,588 @@ struct IterativeDeepening {
             Impl::on_exit(state, alpha, beta, depth, value, terminal);
             size_t subtree_size = pnode_count - size_before.top();
             size_before.pop();
-            tt.insert(state, TTEntry(value), subtree_size);
+            tt->insert(state, TTEntry(value), subtree_size);
             if (depth == 0)
                 pnode_count = 0;
         }
-        void gen_moves(const State<size> &state, std::vector<Move> &moves) {
-            entry = nullptr; // this pointer may be invalidated by insertion of child nodes, null it
-                             // for safety
-
-            Impl::gen_moves(state, moves);
-        }
+        template <bool NullWindow = false>
         void update(Move move, minimax_t &alpha, minimax_t &beta, return_t &parent,
                     return_t &child) const {
-            parent.best_move = move;
-            Impl::update(move, alpha, beta, parent, child);
+            // the first child to reach the parent's value, which is the cutoff move after a fail
+            // high
+            bool better = move.color == BLACK ? child.minimax > parent.minimax
+                                              : child.minimax < parent.minimax;
+            if (better || parent.best_move.color == EMPTY)
+                parent.best_move = move;
+            Impl::template update<NullWindow>(move, alpha, beta, parent, child);
         }
     };
 
-    ABImpl<size, ImplWrapper> impl;
+    typedef ABImpl<size, ImplWrapper> Searcher;
+
+    Searcher impl;
     std::function<void(typename ImplWrapper::return_t)> callback;
     size_t give_up = 0;
+    size_t probe_count = 0; // null window searches over all iterations
+    optional<typename Impl::minimax_t> guess; // first MTD(f) guess, or the evaluator's if unset
     typename Impl::return_t last_result = typename Impl::return_t(0);
+    // budgets for search(). when one runs out, search() returns the last completed probe, marked
+    // inexact, and the bounds below tell what was proven
+    SearchLimits limits;
+    // the window given to search(), narrowed by every exact probe
+    typename Impl::minimax_t lower_bound = Impl::alpha_init(), upper_bound = Impl::beta_init();
+
+    // the engine stays warm from one search to the next. the transposition table only holds
+    // proven values, which hold whatever the root, and the move ordering table is kept too. the
+    // first guess comes from the table's bound on the new root, or else from the last value when
+    // the new root follows from the last solved one. iterations still start from the first
+    // cutoff: starting deep, where the last search ended, was much slower.
+    bool warm_start = true;
+    optional<State<size>> last_root;
+    optional<typename Impl::minimax_t> warm_guess;
+    bool verbose = true; // print progress, off while pondering
+    const OpeningBook<size> *book = nullptr; // answers the first plies, see consult_book()
+
+    // lazy SMP: with more than one thread, helpers search the same root alongside the main
+    // searcher. each has its own stacks and move ordering but they all share one transposition
+    // table, so helpers mostly serve to fill it. only the main searcher's result is used.
+    size_t threads = 1;
+    std::vector<std::unique_ptr<Searcher>> helpers;
+    std::function<void(Searcher &)> configure_helper; // e.g. to silence per-searcher output
+    // with more than one thread, probe several MTD thresholds at once instead of lazy SMP
+    bool parallel_probes = false;
+
+    // where iterate() stands: the iteration, the bounds on the value proven so far, and the
+    // interval and guess of the MTD(f) probes in the current iteration
+    struct Progress {
+        size_t cutoff;
+        typename Impl::minimax_t alpha, beta, lowerbound, upperbound, g;
+        bool all_exact;
+    };
+    // with a file set, the main searcher checkpoints between probes once the interval has passed,
+    // and when halted. the serial and lazy SMP modes checkpoint, parallel probes do not.
+    std::string checkpoint_file;
+    std::chrono::steady_clock::duration checkpoint_interval = std::chrono::minutes(10);
+    std::chrono::steady_clock::time_point last_checkpoint;
+    optional<Progress> resume_from; // set by resume()
 
     typename ImplWrapper::return_t
     search(State<size> &state, typename ImplWrapper::minimax_t alpha = Impl::alpha_init(),
            typename ImplWrapper::minimax_t beta = Impl::beta_init(), size_t depth = 0) {
-        impl.impl.cutoff = 1;
-        typename ImplWrapper::minimax_t f = 0;
-        f = std::max(alpha + 1, std::min(beta - 1, f));
+        return solve(state, alpha, beta, depth, {});
+    }
+
+    // search() with a first guess for when neither the table nor the last root gives one
+    typename ImplWrapper::return_t solve(State<size> &state, typename ImplWrapper::minimax_t alpha,
+                                         typename ImplWrapper::minimax_t beta, size_t depth,
+                                         optional<typename Impl::minimax_t> fallback) {
         std::srand(unsigned(std::time(0)));
-        while (true) {
+        if (!impl.impl.tt)
+            impl.impl.tt = std::make_shared<TranspositionTable<size, TTEntry>>();
+        limits.begin();
+        impl.limits = &limits;
+        if (auto val = consult_book(state, alpha, beta)) {
+            last_root = state;
+            last_result = *val;
+            lower_bound = upper_bound = val->minimax;
+            return *val;
+        }
+        lower_bound = alpha, upper_bound = beta;
+        warm_up(state, fallback);
+        auto val = search_threads(state, alpha, beta, depth);
+        if (val.exact)
+            last_root = state;
+        return val;
+    }
+
+    // the value of a position in the book, or of the position after the book move from one. the
+    // other moves from a book position can not do better than it, which bounds the window.
+    optional<typename ImplWrapper::return_t> consult_book(const State<size> &state,
+                                                          typename Impl::minimax_t &alpha,
+                                                          typename Impl::minimax_t &beta) const {
+        if (!book || state.terminal())
+            return {};
+        optional<typename ImplWrapper::return_t> val;
+        if (auto hit = book->probe(state)) {
+            val = true_score(hit->value);
+            val->best_move = hit->best;
+        } else if (!state.past.empty()) {
+            Move last = std::get<2>(state.past.top());
+            State<size> parent = state;
+            parent.undo();
+            auto hit = book->probe(parent);
+            if (!hit)
+                return {};
+            if (hit->best.is_pass == last.is_pass &&
+                (last.is_pass || hit->best.position == last.position))
+                val = true_score(hit->value);
+            else if (parent.to_play == BLACK)
+                beta = std::max(alpha + 1, std::min(beta, hit->value + 1));
+            else
+                alpha = std::min(beta - 1, std::max(alpha, hit->value - 1));
+        }
+        if (!val || val->minimax <= alpha || val->minimax >= beta)
+            return {};
+        val->type = NodeType::PV;
+        if (verbose)
+            std::cout << "book value " << val->minimax << std::endl;
+        return val;
+    }
+
+    struct RootMove {
+        Move move;
+        typename ImplWrapper::return_t value; // clipped to the window, like search()
+        std::vector<Move> pv;                 // starting with move
+    };
+    // the value of every legal move at the root, best first for the player to move, for move
+    // charts. the moves share the table, and each is first probed at the best value so far, which
+    // tells right away whether it is worse. the node and time limits apply to each move, and a
+    // move whose limit runs out gets an inexact value. a stop ends the chart at the move being
+    // searched.
+    std::vector<RootMove> search_moves(State<size> &state,
+                                       typename ImplWrapper::minimax_t alpha = Impl::alpha_init(),
+                                       typename ImplWrapper::minimax_t beta = Impl::beta_init()) {
+        std::vector<RootMove> result;
+        if (state.terminal())
+            return result;
+        // the likely good moves come first, so the best value is known early
+        std::vector<Move> moves;
+        impl.impl.gen_moves(state, moves);
+        pos_t legal = state.legal_moves(state.to_play);
+        bool pass = false;
+        for (Move m : moves) {
+            if (m.is_pass)
+                pass = true;
+            else
+                legal &= ~(1 << m.position);
+        }
+        for (pos_t i = 0; i < size; i++)
+            if (legal & (1 << i))
+                moves.emplace_back(state.to_play, i);
+        if (!pass)
+            moves.emplace_back(state.to_play);
+
+        bool black = state.to_play == BLACK;
+        optional<typename Impl::minimax_t> best;
+        for (Move m : moves) {
+            state.play(m);
+            RootMove root_move{m, true_score(state.board.minimax()), {m}};
+            if (!state.terminal()) {
+                root_move.value = solve(state, alpha, beta, 0, best);
+                auto v = root_move.value.minimax;
+                if (root_move.value.exact && alpha < v && v < beta)
+                    for (Move reply : principal_variation(state, v))
+                        root_move.pv.push_back(reply);
+            }
+            state.undo();
+            auto v = root_move.value.minimax;
+            if (root_move.value.exact && (!best || (black ? v > *best : v < *best)))
+                best = v;
+            result.push_back(root_move);
+            if (limits.stop)
+                break;
+        }
+        std::stable_sort(result.begin(), result.end(), [&](const auto &a, const auto &b) {
+            return black ? a.value.minimax > b.value.minimax : a.value.minimax < b.value.minimax;
+        });
+        return result;
+    }
+
+    // whether the value of state is at least k, deciding only that. each iteration runs a single
+    // null window probe at k and the first exact one settles the question, where search() would go
+    // on to the exact value. whether white holds black to at most k is !solve_at_least(k + 1).
+    // unset if a limit or give_up ends the search first. only the main searcher is used.
+    optional<bool> solve_at_least(State<size> &state, typename Impl::minimax_t k) {
+        if (k <= Impl::alpha_init())
+            return true;
+        if (k > Impl::beta_init())
+            return false;
+        if (!impl.impl.tt)
+            impl.impl.tt = std::make_shared<TranspositionTable<size, TTEntry>>();
+        limits.begin();
+        impl.limits = &limits;
+        typename ImplWrapper::minimax_t alpha = Impl::alpha_init(), beta = Impl::beta_init();
+        lower_bound = alpha, upper_bound = beta;
+        for (impl.impl.cutoff = 1;; impl.impl.cutoff += 2) {
+            if (impl.impl.cutoff == give_up ||
+                (limits.max_cutoff && impl.impl.cutoff > limits.max_cutoff))
+                return {};
+            auto val = impl.search(state, k - 1, k);
+            if (impl.halted())
+                return {};
+            report(val, alpha, beta);
+            if (val.exact)
+                return val.minimax >= k;
+        }
+    }
+
+    // a line from state along which the player to move reaches value at every step. a step is
+    // proven by the table when it can, otherwise by a null window probe of the move, which the
+    // table from solving state makes cheap. the line ends early if a probe is inexact.
+    std::vector<Move> principal_variation(State<size> state, typename Impl::minimax_t value) {
+        std::vector<Move> pv;
+        std::vector<Move> moves;
+        while (!state.terminal() && pv.size() < 4 * size && !limits.hit()) {
+            bool black = state.to_play == BLACK;
+            if (book) {
+                auto hit = book->probe(state);
+                if (hit && hit->value == value) {
+                    pv.push_back(hit->best);
+                    state.play(hit->best);
+                    continue;
+                }
+            }
+            moves.clear();
+            impl.impl.gen_moves(state, moves);
+            bool found = false;
+            for (Move m : moves) {
+                state.play(m);
+                TTEntry entry;
+                if (state.terminal()) {
+                    found = state.board.minimax() == value;
+                } else if (impl.impl.tt->lookup(state, entry) && entry.node.exact &&
+                           (entry.node.type == NodeType::PV ||
+                            entry.node.type == (black ? NodeType::MAX : NodeType::MIN))) {
+                    auto v = entry.node.minimax;
+                    found = entry.node.type == NodeType::PV ? v == value
+                                                            : black ? v >= value : v <= value;
+                } else {
+                    auto v = black ? impl.search(state, value - 1, value)
+                                   : impl.search(state, value, value + 1);
+                    found = v.exact && (black ? v.minimax >= value : v.minimax <= value);
+                }
+                if (found) {
+                    pv.push_back(m);
+                    break;
+                }
+                state.undo();
+            }
+            if (!found)
+                break;
+        }
+        return pv;
+    }
+
+    // the number of moves leading from the last solved root to state, if it follows from it
+    optional<size_t> plies_since_last(State<size> state) const {
+        if (!last_root || state.past.size() < last_root->past.size())
+            return {};
+        size_t plies = state.past.size() - last_root->past.size();
+        for (size_t i = 0; i < plies; i++)
+            state.undo();
+        if (state != *last_root)
+            return {};
+        return plies;
+    }
+
+    // sets the first guess of a warm start
+    void warm_up(const State<size> &state, optional<typename Impl::minimax_t> fallback) {
+        warm_guess = {};
+        if (!warm_start) {
+            warm_guess = fallback;
+            return;
+        }
+        TTEntry entry;
+        if (impl.impl.tt->lookup(state, entry) && entry.node.exact)
+            warm_guess = entry.node.minimax;
+        // past the book, the value of the last book position on the way
+        if (book) {
+            for (State<size> s = state; !warm_guess && !s.past.empty();) {
+                s.undo();
+                if (auto hit = book->probe(s))
+                    warm_guess = hit->value;
+            }
+        }
+        auto plies = plies_since_last(state);
+        if (!plies) {
+            if (!warm_guess)
+                warm_guess = fallback;
+            return;
+        }
+        if (!warm_guess)
+            warm_guess = last_result.minimax;
+        if (verbose)
+            std::cout << "warm start " << *plies << " plies after the last root" << std::endl;
+    }
+
+    // searches the positions after the first few moves from root, the best first, so that the
+    // transposition table is ready for the queries likely to come next. their results are thrown
+    // away and what the last search left behind is restored. raise limits.stop to cancel.
+    void ponder(State<size> root, size_t replies) {
+        if (root.terminal() || !impl.impl.tt)
+            return;
+        auto saved = std::make_tuple(last_root, last_result, probe_count, lower_bound, upper_bound);
+        std::function<void(typename ImplWrapper::return_t)> saved_callback;
+        std::string saved_checkpoint;
+        std::swap(callback, saved_callback);
+        std::swap(checkpoint_file, saved_checkpoint);
+        verbose = false;
+
+        std::vector<Move> moves;
+        impl.impl.gen_moves(root, moves);
+        TTEntry entry;
+        if (impl.impl.tt->lookup(root, entry) && entry.node.exact) {
+            Move best = entry.node.best_move;
+            auto it = std::find_if(moves.begin(), moves.end(), [&](Move m) {
+                return m.color == best.color && m.is_pass == best.is_pass &&
+                       (m.is_pass || m.position == best.position);
+            });
+            if (it != moves.end())
+                std::rotate(moves.begin(), it, it + 1);
+        }
+        for (size_t i = 0; i < std::min(replies, moves.size()) && !limits.stop; i++) {
+            root.play(moves[i]);
+            if (!root.terminal())
+                search(root);
+            root.undo();
+        }
+
+        verbose = true;
+        std::swap(callback, saved_callback);
+        std::swap(checkpoint_file, saved_checkpoint);
+        std::tie(last_root, last_result, probe_count, lower_bound, upper_bound) = saved;
+    }
+
+    // a guess given by the user wins over a warm start, which wins over the evaluator
+    typename Impl::minimax_t first_guess(Searcher &searcher, const State<size> &state) const {
+        if (guess)
+            return *guess;
+        if (warm_guess)
+            return *warm_guess;
+        return searcher.impl.evaluator(state);
+    }
+
+    void forget() {
+        if (impl.impl.tt)
+            impl.impl.tt->clear();
+        impl.order_table.clear();
+        for (auto &h : helpers)
+            h->order_table.clear();
+        last_root = {};
+        warm_guess = {};
+    }
+
+    typename ImplWrapper::return_t
+    search_threads(State<size> &state, typename ImplWrapper::minimax_t alpha,
+                   typename ImplWrapper::minimax_t beta, size_t depth) {
+        if (threads <= 1)
+            return iterate(impl, state, alpha, beta, depth, 1, true);
+
+        impl.impl.tt->shared = true;
+        while (helpers.size() < threads - 1) {
+            helpers.emplace_back(std::make_unique<Searcher>());
+            Searcher &h = *helpers.back();
+            h.vary_order = true;
+            h.order_rng.seed(unsigned(helpers.size()));
+            h.impl.quiescence_depth = impl.impl.quiescence_depth;
+            h.impl.evaluator = impl.impl.evaluator;
+            if (configure_helper)
+                configure_helper(h);
+        }
+        for (size_t i = 0; i < threads - 1; i++) {
+            helpers[i]->impl.tt = impl.impl.tt;
+            helpers[i]->limits = &limits;
+            helpers[i]->tablebase = impl.tablebase;
+            helpers[i]->endgame.max_empty = impl.endgame.max_empty;
+            helpers[i]->quit = false;
+        }
+        if (parallel_probes) {
+            auto val = probe_parallel(state, alpha, beta, depth);
+            impl.impl.tt->shared = false;
+            return val;
+        }
+
+        std::vector<std::thread> workers;
+        for (size_t i = 0; i < threads - 1; i++) {
+            Searcher &h = *helpers[i];
+            // odd helpers start one iteration deeper than the main searcher
+            size_t first_cutoff = i % 2 ? 1 : 3;
+            workers.emplace_back([&, first_cutoff, root = state]() mutable {
+                iterate(h, root, alpha, beta, depth, first_cutoff, false);
+            });
+        }
+        auto val = iterate(impl, state, alpha, beta, depth, 1, true);
+        for (size_t i = 0; i < workers.size(); i++) {
+            helpers[i]->quit = true;
+            workers[i].join();
+        }
+        impl.impl.tt->shared = false;
+        return val;
+    }
+
+    // reports a finished probe of the main search and narrows the bounds given to search()
+    void report(const typename ImplWrapper::return_t &val, typename ImplWrapper::minimax_t &alpha,
+                typename ImplWrapper::minimax_t &beta) {
+        probe_count++;
+        last_result = val;
+        if (callback)
+            callback(val);
+        if (val.exact && val.type == NodeType::MIN)
+            beta = std::min(beta, val.minimax);
+        if (val.exact && val.type == NodeType::MAX)
+            alpha = std::max(alpha, val.minimax);
+        lower_bound = alpha, upper_bound = beta;
+        if (val.exact && verbose) {
+            std::cout << "found exact " << val.type << " of " << val.minimax << std::endl;
+        }
+    }
+
+    // parallel MTD: each round probes one threshold per searcher. two bracket the current guess,
+    // which settles the value in one round when the guess is right, and the rest split the
+    // interval the value is known to lie in evenly. as results come in the interval narrows,
+    // probes whose threshold has fallen outside it are cancelled, and the next round starts
+    // from the latest result.
+    typename ImplWrapper::return_t probe_parallel(State<size> &state,
+                                                  typename ImplWrapper::minimax_t alpha,
+                                                  typename ImplWrapper::minimax_t beta,
+                                                  size_t depth) {
+        typedef typename ImplWrapper::minimax_t minimax_t;
+        std::vector<Searcher *> searchers{&impl};
+        for (size_t i = 0; i < threads - 1; i++)
+            searchers.push_back(helpers[i].get());
+        minimax_t f = first_guess(impl, state);
+        typename ImplWrapper::return_t best = heuristic_score(f);
+        for (size_t cutoff = 1;; cutoff += 2) {
             typename Impl::return_t val(f);
-            if (impl.impl.cutoff == give_up) {
-                std::cout << "giving up\n";
+            if (cutoff == give_up || (limits.max_cutoff && cutoff > limits.max_cutoff)) {
+                if (verbose)
+                    std::cout << "giving up\n";
+                return best;
+            }
+            for (Searcher *s : searchers)
+                s->impl.cutoff = cutoff;
+            minimax_t lower = alpha, upper = beta;
+            // the results which attained the bounds, either is the value once they meet
+            optional<typename ImplWrapper::return_t> at_lower, at_upper;
+            bool all_exact = true;
+            while (lower < upper) {
+                size_t width = upper - lower, n = std::min(searchers.size(), width);
+                std::vector<minimax_t> thresholds;
+                auto add = [&](minimax_t b) {
+                    if (thresholds.size() < n && b > lower && b <= upper &&
+                        std::find(thresholds.begin(), thresholds.end(), b) == thresholds.end())
+                        thresholds.push_back(b);
+                };
+                add(f);
+                add(f + 1);
+                size_t spread = n - thresholds.size();
+                for (size_t i = 0; i < spread; i++)
+                    add(lower + 1 +
+                        minimax_t(std::min(width - 1, (2 * i + 1) * width / (2 * spread))));
+                // points of the spread may coincide with the guess, fill up from the bottom
+                for (minimax_t b = lower + 1; b <= upper; b++)
+                    add(b);
+
+                std::vector<optional<typename ImplWrapper::return_t>> results(n);
+                std::mutex lock;
+                std::condition_variable finished;
+                std::vector<std::thread> workers;
+                for (size_t i = 0; i < n; i++)
+                    workers.emplace_back([&, i, root = state]() mutable {
+                        auto v =
+                            searchers[i]->search(root, thresholds[i] - 1, thresholds[i], depth);
+                        std::lock_guard<std::mutex> l(lock);
+                        results[i] = v;
+                        finished.notify_one();
+                    });
+                std::vector<bool> folded(n), cancelled(n);
+                bool halted = false;
+                for (size_t count = 0; count < n;) {
+                    std::unique_lock<std::mutex> l(lock);
+                    finished.wait(l, [&] {
+                        for (size_t i = 0; i < n; i++)
+                            if (results[i] && !folded[i])
+                                return true;
+                        return false;
+                    });
+                    for (size_t i = 0; i < n; i++) {
+                        if (!results[i] || folded[i])
+                            continue;
+                        folded[i] = true;
+                        count++;
+                        if (cancelled[i])
+                            continue;
+                        auto v = *results[i];
+                        report(v, alpha, beta);
+                        best = v;
+                        all_exact &= v.exact;
+                        if (v.minimax < thresholds[i]) {
+                            if (v.minimax < upper)
+                                upper = v.minimax, at_upper = v;
+                        } else if (v.minimax > lower) {
+                            lower = v.minimax, at_lower = v;
+                        }
+                        f = v.minimax;
+                    }
+                    // the main searcher is halted from outside, which stops every probe
+                    halted |= (impl.quit && !cancelled[0]) || limits.hit();
+                    for (size_t i = 0; i < n; i++) {
+                        if (!folded[i] &&
+                            (halted || thresholds[i] <= lower || thresholds[i] > upper)) {
+                            cancelled[i] = true;
+                            searchers[i]->quit = true;
+                        }
+                    }
+                }
+                for (size_t i = 0; i < n; i++) {
+                    workers[i].join();
+                    if (cancelled[i])
+                        searchers[i]->quit = false;
+                }
+                if (halted) {
+                    best.exact = false;
+                    return best;
+                }
+            }
+            if (at_lower || at_upper)
+                val = at_lower ? *at_lower : *at_upper;
+            if (all_exact)
                 return val;
+            f = val.minimax;
+        }
+    }
+
+    // iterative deepening over MTD(f) with one searcher. only the main searcher reports progress,
+    // narrows the bounds it is given and checkpoints.
+    typename ImplWrapper::return_t iterate(Searcher &searcher, State<size> &state,
+                                           typename ImplWrapper::minimax_t alpha,
+                                           typename ImplWrapper::minimax_t beta, size_t depth,
+                                           size_t first_cutoff, bool main) {
+        searcher.impl.cutoff = first_cutoff;
+        typename ImplWrapper::minimax_t f = first_guess(searcher, state);
+        bool resuming = main && resume_from;
+        Progress resumed{};
+        if (resuming) {
+            resumed = *resume_from;
+            resume_from = {};
+            searcher.impl.cutoff = resumed.cutoff;
+            alpha = resumed.alpha, beta = resumed.beta;
+            f = resumed.g;
+        }
+        if (main)
+            last_checkpoint = std::chrono::steady_clock::now();
+        f = std::max(alpha + 1, std::min(beta - 1, f));
+        // the last completed probe, returned when a limit runs out
+        typename ImplWrapper::return_t best = heuristic_score(f);
+        while (true) {
+            typename Impl::return_t val(f);
+            if (searcher.impl.cutoff == give_up ||
+                (limits.max_cutoff && searcher.impl.cutoff > limits.max_cutoff)) {
+                if (main && verbose)
+                    std::cout << "giving up\n";
+                best.exact = false;
+                return best;
             }
             auto g = f;
             auto lowerbound = alpha, upperbound = beta;
             int iter = 0;
             bool all_exact = true;
+            if (resuming) {
+                g = resumed.g;
+                lowerbound = resumed.lowerbound, upperbound = resumed.upperbound;
+                all_exact = resumed.all_exact;
+                resuming = false;
+            }
             while (lowerbound < upperbound) {
                 typename ImplWrapper::minimax_t b;
                 if (g == lowerbound)
@@ -413,19 +1186,17 @@ struct IterativeDeepening {
                 else
                     b = g;
                 //std::cout << "MTD(f) in [" << (b - 1) << ", " << b << "]...\t" << std::flush;
-                val = impl.search(state, b - 1, b, depth);
-                last_result = val;
-                //std::cout << "Result type: " << (val.exact ? "exact " : "inexact ") << val.type
-                          //<< std::endl;
-                if (callback)
-                    callback(val);
-                if (val.exact && val.type == NodeType::MIN)
-                    beta = std::min(beta, val.minimax);
-                if (val.exact && val.type == NodeType::MAX)
-                    alpha = std::max(alpha, val.minimax);
-                if (val.exact) {
-                    std::cout << "found exact " << val.type << " of " << val.minimax << std::endl;
+                val = searcher.search(state, b - 1, b, depth);
+                if (searcher.halted()) {
+                    if (main && !checkpoint_file.empty())
+                        save_checkpoint(state, Progress{searcher.impl.cutoff, alpha, beta,
+                                                        lowerbound, upperbound, g, all_exact});
+                    best.exact = false;
+                    return best;
                 }
+                if (main)
+                    report(val, alpha, beta);
+                best = val;
                 all_exact &= val.exact;
                 g = val.minimax;
                 if (g < b)
@@ -433,6 +1204,10 @@ struct IterativeDeepening {
                 else
                     lowerbound = g;
                 iter++;
+                if (main && !checkpoint_file.empty() &&
+                    std::chrono::steady_clock::now() - last_checkpoint >= checkpoint_interval)
+                    save_checkpoint(state, Progress{searcher.impl.cutoff, alpha, beta, lowerbound,
+                                                    upperbound, g, all_exact});
                 //std::cout << std::endl;
             }
             if (all_exact) {
@@ -443,10 +1218,183 @@ struct IterativeDeepening {
                 return val;
             }
             f = val.minimax;
-            impl.impl.cutoff += 2;
+            searcher.impl.cutoff += 2;
+        }
+    }
+
+    // a checkpoint holds the root, the position of iterate() in its loops, the transposition
+    // table and the main searcher's move ordering table. the PV below a table entry is not kept.
+    static constexpr char CHECKPOINT_MAGIC[4] = {'L', 'G', 'O', 'C'};
+    static constexpr uint32_t CHECKPOINT_VERSION = 1;
+
+    bool save_checkpoint(const State<size> &state, const Progress &progress) {
+        std::string tmp = checkpoint_file + ".tmp";
+        std::ofstream out(tmp, std::ios::binary | std::ios::trunc);
+        auto put = [&](auto x) { out.write(reinterpret_cast<const char *>(&x), sizeof(x)); };
+        auto put_move = [&](Move m) {
+            put(m.color.value);
+            put(m.position);
+            put(m.is_pass);
+        };
+        out.write(CHECKPOINT_MAGIC, 4);
+        put(CHECKPOINT_VERSION);
+        put(uint32_t(size));
+
+        std::vector<Move> moves;
+        for (auto past = state.past; !past.empty(); past.pop())
+            moves.push_back(std::get<2>(past.top()));
+        std::reverse(moves.begin(), moves.end());
+        put(uint64_t(moves.size()));
+        for (Move m : moves)
+            put_move(m);
+        put(progress);
+
+        auto &tt = *impl.impl.tt;
+        put(uint64_t(tt.SIZE));
+        for (size_t i = 0; i < tt.SIZE; i++) {
+            auto l = tt.lock(i);
+            auto &e = tt.table[i];
+            if (!e.valid)
+                continue;
+            put(uint64_t(i));
+            put(e.board);
+            std::vector<Board<size>> history;
+            e.history.for_each([&](Board<size> b) { history.push_back(b); });
+            put(uint64_t(history.size()));
+            for (Board<size> b : history)
+                put(b);
+            put(e.game_state);
+            put(e.to_play.value);
+            put(uint64_t(e.hash));
+            put(uint64_t(e.entry_score));
+            put(uint64_t(e.val.score));
+            put(e.val.node.minimax);
+            put(e.val.node.exact);
+            put(e.val.node.type);
+            put_move(e.val.node.best_move);
+        }
+        put(uint64_t(-1));
+
+        for (size_t i = 0; i < impl.order_table.size(); i++) {
+            auto &order = impl.order_table[i];
+            if (order.empty())
+                continue;
+            put(uint64_t(i));
+            put(uint64_t(order.size()));
+            for (auto &t : order) {
+                put(std::get<0>(t));
+                put(uint64_t(std::get<1>(t)));
+                put_move(std::get<2>(t));
+            }
+        }
+        put(uint64_t(-1));
+        out.close();
+        if (!out || std::rename(tmp.c_str(), checkpoint_file.c_str()) != 0) {
+            std::cout << "could not write checkpoint " << checkpoint_file << std::endl;
+            return false;
+        }
+        last_checkpoint = std::chrono::steady_clock::now();
+        std::cout << "checkpoint at cutoff " << progress.cutoff << ", value in ["
+                  << progress.lowerbound << ", " << progress.upperbound << "]" << std::endl;
+        return true;
+    }
+
+    // loads a checkpoint into root, the transposition table and the ordering table. the next
+    // search of root picks up where the checkpointed one stopped.
+    bool resume(const std::string &filename, State<size> &root) {
+        std::ifstream in(filename, std::ios::binary);
+        auto get = [&](auto &x) { in.read(reinterpret_cast<char *>(&x), sizeof(x)); };
+        auto get_move = [&]() {
+            pos_t color, position;
+            bool is_pass;
+            get(color);
+            get(position);
+            get(is_pass);
+            return is_pass ? Move(Cell(color)) : Move(Cell(color), position);
+        };
+        char magic[4];
+        uint32_t version, file_size;
+        if (!in.read(magic, 4) || std::memcmp(magic, CHECKPOINT_MAGIC, 4) != 0)
+            return false;
+        get(version);
+        get(file_size);
+        if (!in || version != CHECKPOINT_VERSION || file_size != size)
+            return false;
+
+        uint64_t count;
+        get(count);
+        root = State<size>();
+        for (uint64_t i = 0; i < count && in; i++)
+            root.play(get_move());
+        Progress progress;
+        get(progress);
+
+        if (!impl.impl.tt)
+            impl.impl.tt = std::make_shared<TranspositionTable<size, TTEntry>>();
+        auto &tt = *impl.impl.tt;
+        uint64_t tt_size;
+        get(tt_size);
+        if (!in || tt_size != tt.SIZE)
+            return false;
+        tt.clear();
+        for (uint64_t i; get(i), in && i != uint64_t(-1);) {
+            if (i >= tt.SIZE)
+                return false;
+            auto &e = tt.table[i];
+            get(e.board);
+            e.history = History<size>();
+            uint64_t history_size, hash, entry_score, score;
+            get(history_size);
+            for (uint64_t j = 0; j < history_size; j++) {
+                Board<size> b;
+                get(b);
+                e.history.add(b);
+            }
+            get(e.game_state);
+            pos_t to_play;
+            get(to_play);
+            e.to_play = Cell(to_play);
+            get(hash);
+            get(entry_score);
+            get(score);
+            typename Impl::minimax_t minimax;
+            get(minimax);
+            Node node(minimax);
+            get(node.exact);
+            get(node.type);
+            node.best_move = get_move();
+            e.hash = hash;
+            e.entry_score = entry_score;
+            e.val = TTEntry(node);
+            e.val.score = score;
+            e.valid = true;
         }
+
+        if (impl.order_table.empty())
+            impl.order_table.resize(Searcher::ORDER_TABLE_SIZE);
+        for (auto &order : impl.order_table)
+            order.clear();
+        for (uint64_t i; get(i), in && i != uint64_t(-1);) {
+            if (i >= impl.order_table.size())
+                return false;
+            uint64_t n, subtree_size;
+            get(n);
+            for (uint64_t j = 0; j < n && in; j++) {
+                int value;
+                get(value);
+                get(subtree_size);
+                Move m = get_move();
+                impl.order_table[i].emplace_back(value, subtree_size, m);
+            }
+        }
+        if (!in)
+            return false;
+        resume_from = progress;
+        return true;
     }
 };
+template <pos_t size, template <pos_t, typename> typename ABImpl, typename Impl>
+constexpr char IterativeDeepening<size, ABImpl, Impl>::CHECKPOINT_MAGIC[4];
 template <pos_t size, typename Impl = PV<size>>
 using IterativeDeepeningAlphaBeta = IterativeDeepening<size, AlphaBeta, Impl>;
 
@@ -477,6 +1425,7 @@ template <pos_t size, typename Impl> struct NewickTree : Impl {
 
     size_t tree_depth_cutoff = 4;
     std::string output_filename = "searchtree.nhx";
+    bool write_file = true;
 
     std::stringstream output;
     std::stack<bool> need_close;
@@ -545,10 +1494,12 @@ template <pos_t size, typename Impl> struct NewickTree : Impl {
 
         if (depth == 0) {
             output << ";" << std::endl;
-            std::ofstream outfile;
-            outfile.open(output_filename, std::ios::out | std::ios::trunc);
-            outfile << output.str();
-            outfile.close();
+            if (write_file) {
+                std::ofstream outfile;
+                outfile.open(output_filename, std::ios::out | std::ios::trunc);
+                outfile << output.str();
+                outfile.close();
+            }
             output.str(std::string());
             output.clear();
             node_count = 0;
@@ -1,6 +1,10 @@
 #include "catch.hpp"
 #include "ab.hpp"
 #include "conjectures.hpp"
+#include "dfpn.hpp"
+#include "gen_book.hpp"
+#include "gen_tablebase.hpp"
+#include "parallel.hpp"
 
 TEST_CASE("alpha beta size 1", "[search]") {
     AlphaBeta<1> ab;
@@ -260,3 +264,635 @@ TEST_CASE("size 7", "[search]") {
         REQUIRE(ab.search(root).minimax == -7);
     }
 }
+
+TEST_CASE("trained move ordering keeps values", "[search]") {
+    constexpr int size = 6;
+    OrderingTrainer<size> trainer;
+    State<size> s;
+    trainer.observe(s.board, Move(BLACK, 1), false, true);
+    trainer.observe(s.board, Move(BLACK, 2), false, false);
+    OrderingWeights<size> weights = trainer.fit();
+    REQUIRE(weights.weight(s.board, Move(BLACK, 1), false) >
+            weights.weight(s.board, Move(BLACK, 2), false));
+    REQUIRE(weights.save("ordering.test.bin"));
+    REQUIRE(OrderingWeights<size>::global.load("ordering.test.bin"));
+    std::remove("ordering.test.bin");
+    REQUIRE(OrderingWeights<size>::global.weights == weights.weights);
+
+    AlphaBeta<size> ab;
+    REQUIRE(ab.search(s) == 1);
+    s.play(Move(BLACK, 2));
+    REQUIRE(ab.search(s) == -1);
+    OrderingWeights<size>::global.loaded = false;
+}
+
+// plain alpha beta over every legal move, without any pruning rules or static bounds
+template <pos_t size> int exhaustive_minimax(State<size> &state, int alpha, int beta) {
+    if (state.terminal())
+        return state.board.minimax();
+    // passing after a pass ends the game
+    if (state.game_state == State<size>::PASS) {
+        if (state.to_play == BLACK)
+            alpha = std::max(alpha, state.board.minimax());
+        else
+            beta = std::min(beta, state.board.minimax());
+        if (alpha >= beta)
+            return state.to_play == BLACK ? alpha : beta;
+    }
+    std::vector<Move> moves;
+    pos_t legal = state.legal_moves(state.to_play);
+    for (pos_t i = 0; i < size; i++)
+        if (legal & (1 << i))
+            moves.emplace_back(state.to_play, i);
+    moves.emplace_back(state.to_play);
+    int best = state.to_play == BLACK ? -int(size) : int(size);
+    for (Move m : moves) {
+        state.play(m);
+        int v = exhaustive_minimax(state, alpha, beta);
+        state.undo();
+        if (m.color == BLACK)
+            best = std::max(best, v), alpha = std::max(alpha, v);
+        else
+            best = std::min(best, v), beta = std::min(beta, v);
+        if (alpha >= beta)
+            break;
+    }
+    return best;
+}
+
+template <pos_t size> void check_static_bounds(State<size> &state, size_t depth, size_t &checked) {
+    if (state.terminal())
+        return;
+    int lower = StaticBounds<size>::lower(state.board);
+    int upper = StaticBounds<size>::upper(state.board);
+    int value = exhaustive_minimax(state, -int(size), int(size));
+    REQUIRE(lower <= value);
+    REQUIRE(value <= upper);
+    checked += lower != -int(size) || upper != int(size);
+    if (depth == 0)
+        return;
+    pos_t legal = state.legal_moves(state.to_play);
+    for (pos_t i = 0; i < size; i++) {
+        if (legal & (1 << i)) {
+            state.play(Move(state.to_play, i));
+            check_static_bounds(state, depth - 1, checked);
+            state.undo();
+        }
+    }
+}
+
+TEST_CASE("static bounds", "[bounds]") {
+    Board<7> b;
+    b.set(1, BLACK), b.set(3, BLACK);
+    REQUIRE(StaticBounds<7>::safe_cells(b, BLACK) == 0);
+    b.set(5, BLACK);
+    REQUIRE(StaticBounds<7>::safe_cells(b, BLACK) == 0b1111111);
+    REQUIRE(StaticBounds<7>::lower(b) == 7);
+
+    // the white stone keeps the eye beside it from scoring
+    Board<6> c;
+    c.set(0, WHITE), c.set(2, BLACK), c.set(4, BLACK);
+    REQUIRE(StaticBounds<6>::safe_cells(c, BLACK) == 0b111100);
+    REQUIRE(StaticBounds<6>::safe_cells(c, WHITE) == 0);
+    REQUIRE(StaticBounds<6>::lower(c) == 2);
+    REQUIRE(StaticBounds<6>::upper(c) == 6);
+}
+
+TEST_CASE("static bounds are sound", "[bounds]") {
+    size_t checked = 0;
+    {
+        State<4> s;
+        check_static_bounds(s, 4, checked);
+    }
+    {
+        State<5> s;
+        check_static_bounds(s, 3, checked);
+    }
+    REQUIRE(checked > 0);
+}
+
+TEST_CASE("capture extension keeps values", "[search]") {
+    constexpr int size = 6;
+    using Impl = conjectures::All<size, PV<size>>;
+    IterativeDeepening<size, AlphaBeta, Impl> ab;
+    ab.impl.impl.quiescence_depth = 4;
+    {
+        State<size> root;
+        REQUIRE(ab.search(root).minimax == 1);
+    }
+    {
+        State<size> root;
+        root.play(Move(BLACK, 2));
+        REQUIRE(ab.search(root).minimax == -1);
+    }
+    REQUIRE(ab.impl.impl.quiescence_nodes > 0);
+}
+
+TEST_CASE("static evaluators", "[eval]") {
+    State<7> s;
+    s.play(Move(BLACK, 1));
+    s.play(Move(WHITE, 5));
+    REQUIRE(s.board.minimax() == 0);
+    REQUIRE(InfluenceEvaluator<7>()(s) == 1); // black to play takes the middle cell
+    s.play(Move(BLACK, 3));
+    REQUIRE(s.board.minimax() == 2);
+    REQUIRE(InfluenceEvaluator<7>()(s) == 1); // white to play takes the contested cell
+    s.play(Move(WHITE, 4));
+    REQUIRE(InfluenceEvaluator<7>()(s) == 1);
+    REQUIRE(LibertyEvaluator<7>()(s) == 7); // white is in atari with black to play
+
+    TableEvaluator<7> table;
+    for (int i = 0; i < 100; i++)
+        table.train(s, 3, 0.05);
+    REQUIRE(table(s) == 3);
+}
+
+TEST_CASE("evaluators keep values", "[eval]") {
+    constexpr int size = 6;
+    using Impl = conjectures::All<size, PV<size>>;
+    for (const char *kind : {"influence", "liberties"}) {
+        IterativeDeepening<size, AlphaBeta, Impl> ab;
+        REQUIRE(ab.impl.impl.evaluator.set_kind(kind));
+        State<size> root;
+        REQUIRE(ab.search(root).minimax == 1);
+        root.play(Move(BLACK, 2));
+        REQUIRE(ab.search(root).minimax == -1);
+    }
+}
+
+TEST_CASE("lazy smp", "[search][parallel]") {
+    constexpr int size = 7;
+    using Impl = conjectures::All<size, PV<size>>;
+    IterativeDeepening<size, AlphaBeta, Impl> ab;
+    ab.threads = 3;
+    {
+        State<size> root;
+        REQUIRE(ab.search(root).minimax == 2);
+    }
+    {
+        State<size> root;
+        root.play(Move(BLACK, 2));
+        REQUIRE(ab.search(root).minimax == -2);
+    }
+    REQUIRE(ab.helpers.size() == 2);
+}
+
+template <pos_t size> void check_parallel(std::vector<Move> moves) {
+    State<size> s;
+    for (Move m : moves)
+        s.play(m);
+    AlphaBeta<size> serial;
+    auto expected = serial.search(s);
+    ParallelAlphaBeta<size> one, four;
+    one.threads = 1;
+    four.threads = 4;
+    four.split_depth = 3;
+    auto got = four.search(s);
+    REQUIRE(got.minimax == expected.minimax);
+    REQUIRE(got.exact == expected.exact);
+    REQUIRE(got.type == expected.type);
+    // fail-soft values depend neither on the number of workers nor on scheduling
+    for (int b = -int(size) + 1; b <= int(size) && size < 6; b++) {
+        auto a = one.search(s, b - 1, b), c = four.search(s, b - 1, b);
+        REQUIRE(a.minimax == c.minimax);
+        REQUIRE(a.exact == c.exact);
+        REQUIRE(a.type == c.type);
+        REQUIRE((a.minimax >= b) == (expected.minimax >= b));
+    }
+}
+
+TEST_CASE("parallel alpha beta", "[search][parallel]") {
+    check_parallel<3>({});
+    check_parallel<4>({});
+    check_parallel<5>({});
+    check_parallel<3>({Move(BLACK, 0), Move(WHITE, 1)});
+    check_parallel<5>({Move(BLACK, 2), Move(WHITE, 1), Move(BLACK, 3)});
+    check_parallel<6>({Move(BLACK, 1), Move(WHITE, 4), Move(BLACK, 2)});
+    check_parallel<6>({Move(BLACK, 2), Move(WHITE, 1), Move(BLACK, 5)});
+}
+
+TEST_CASE("parallel probes", "[search][parallel]") {
+    constexpr int size = 7;
+    using Impl = conjectures::All<size, PV<size>>;
+    IterativeDeepening<size, AlphaBeta, Impl> ab;
+    ab.threads = 3;
+    ab.parallel_probes = true;
+    {
+        State<size> root;
+        REQUIRE(ab.search(root).minimax == 2);
+    }
+    {
+        State<size> root;
+        root.play(Move(BLACK, 2));
+        REQUIRE(ab.search(root).minimax == -2);
+    }
+    // with a searcher per threshold the whole range is covered at once
+    IterativeDeepening<4, AlphaBeta, conjectures::All<4, PV<4>>> all;
+    all.threads = 8;
+    all.parallel_probes = true;
+    State<4> root;
+    REQUIRE(all.search(root).minimax == 4);
+}
+
+TEST_CASE("checkpoint and resume", "[search]") {
+    constexpr int size = 6;
+    using Impl = conjectures::All<size, PV<size>>;
+    std::string file = "checkpoint.test.bin";
+    State<size> root;
+    root.play(Move(BLACK, 2));
+
+    IterativeDeepening<size, AlphaBeta, Impl> full;
+    REQUIRE(full.search(root).minimax == -1);
+
+    // halt after a few probes, which leaves a checkpoint behind
+    IterativeDeepening<size, AlphaBeta, Impl> halted;
+    halted.checkpoint_file = file;
+    halted.checkpoint_interval = std::chrono::seconds(0);
+    halted.callback = [&](auto) {
+        if (halted.probe_count == 3)
+            halted.impl.quit = true;
+    };
+    halted.search(root);
+    halted.impl.quit = false;
+
+    IterativeDeepening<size, AlphaBeta, Impl> resumed;
+    State<size> loaded;
+    REQUIRE(resumed.resume(file, loaded));
+    REQUIRE(loaded == root);
+    REQUIRE(resumed.search(loaded).minimax == -1);
+    REQUIRE(halted.probe_count + resumed.probe_count <= full.probe_count + 1);
+    std::remove(file.c_str());
+    std::remove((file + ".tmp").c_str());
+}
+
+TEST_CASE("search limits", "[search]") {
+    constexpr int size = 7;
+    using Impl = conjectures::All<size, PV<size>>;
+    State<size> root;
+
+    // every budget ends the search early with an inexact guess, and the proven bounds still hold
+    // the true value of 2
+    auto check_stopped = [](auto &ab, auto val) {
+        REQUIRE(!val.exact);
+        REQUIRE(ab.lower_bound <= 2);
+        REQUIRE(ab.upper_bound >= 2);
+    };
+    IterativeDeepening<size, AlphaBeta, Impl> ab;
+    ab.limits.nodes = SearchLimits::NODE_BATCH;
+    check_stopped(ab, ab.search(root));
+    ab.limits.nodes = 0;
+
+    ab.limits.max_cutoff = 1;
+    check_stopped(ab, ab.search(root));
+    ab.limits.max_cutoff = 0;
+
+    ab.callback = [&](auto) {
+        if (ab.probe_count == 2)
+            ab.limits.stop = true;
+    };
+    ab.probe_count = 0;
+    check_stopped(ab, ab.search(root));
+    REQUIRE(ab.probe_count == 2);
+    ab.limits.stop = false;
+    ab.callback = nullptr;
+
+    auto val = ab.search(root);
+    REQUIRE(val.exact);
+    REQUIRE(val.minimax == 2);
+    REQUIRE(ab.lower_bound <= 2);
+    REQUIRE(ab.upper_bound >= 2);
+}
+
+TEST_CASE("warm start", "[search]") {
+    constexpr int size = 7;
+    using Impl = conjectures::All<size, PV<size>>;
+    // the bounds of the endgame solver shorten the cold searches too, so the probe counts are
+    // compared without it
+    IterativeDeepening<size, AlphaBeta, Impl> warm;
+    warm.impl.endgame.max_empty = 0;
+    State<size> root;
+    REQUIRE(warm.search(root).minimax == 2);
+
+    // step along a line, each position solved cold as well
+    for (Move m : {Move(BLACK, 3), Move(WHITE, 1), Move(BLACK, 5)}) {
+        root.play(m);
+        REQUIRE(warm.plies_since_last(root) == optional<size_t>(1));
+        IterativeDeepening<size, AlphaBeta, Impl> cold;
+        cold.warm_start = false;
+        cold.impl.endgame.max_empty = 0;
+        auto expected = cold.search(root);
+        warm.probe_count = 0;
+        auto val = warm.search(root);
+        REQUIRE(val.exact);
+        REQUIRE(val.minimax == expected.minimax);
+        REQUIRE(warm.probe_count <= cold.probe_count);
+    }
+
+    // a position which does not follow from the last root starts from scratch
+    State<size> other;
+    other.play(Move(BLACK, 2));
+    REQUIRE(!warm.plies_since_last(other));
+    REQUIRE(warm.search(other).minimax == -2);
+    warm.forget();
+    REQUIRE(!warm.last_root);
+}
+
+TEST_CASE("ponder", "[search]") {
+    constexpr int size = 6;
+    using Impl = conjectures::All<size, PV<size>>;
+    IterativeDeepening<size, AlphaBeta, Impl> ab;
+    State<size> root;
+    root.play(Move(BLACK, 2));
+    REQUIRE(ab.search(root).minimax == -1);
+    size_t probes = ab.probe_count;
+
+    // pondering leaves the last search's results alone
+    ab.ponder(root, 3);
+    REQUIRE(ab.probe_count == probes);
+    REQUIRE(ab.last_result.minimax == -1);
+    REQUIRE(ab.plies_since_last(root) == optional<size_t>(0));
+
+    // the first reply was among those pondered, so its value is already in the table
+    std::vector<Move> moves;
+    ab.impl.impl.gen_moves(root, moves);
+    root.play(moves[0]);
+    auto val = ab.search(root);
+    REQUIRE(val.exact);
+    IterativeDeepening<size, AlphaBeta, Impl> cold;
+    REQUIRE(cold.search(root).minimax == val.minimax);
+    REQUIRE(ab.probe_count - probes <= cold.probe_count);
+    root.undo();
+
+    // a stop cancels pondering from another thread
+    IterativeDeepening<7, AlphaBeta, conjectures::All<7, PV<7>>> big;
+    State<7> empty;
+    big.search(empty);
+    std::thread t([&] { big.ponder(empty, 7); });
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    big.limits.stop = true;
+    t.join();
+    REQUIRE(big.verbose);
+}
+
+TEST_CASE("search moves", "[search]") {
+    constexpr int size = 6;
+    using Impl = conjectures::All<size, PV<size>>;
+    State<size> root;
+    root.play(Move(BLACK, 2));
+
+    // the probe counts are compared without the endgame solver, as in "warm start"
+    IterativeDeepening<size, AlphaBeta, Impl> ab;
+    ab.impl.endgame.max_empty = 0;
+    auto chart = ab.search_moves(root);
+    // every legal move and the pass
+    REQUIRE(chart.size() == size_t(__builtin_popcount(root.legal_moves(WHITE))) + 1);
+    REQUIRE(chart[0].value.minimax == -1);
+    REQUIRE(chart[0].pv.size() > 1);
+
+    size_t cold_probes = 0;
+    for (size_t i = 0; i < chart.size(); i++) {
+        auto &m = chart[i];
+        REQUIRE(m.value.exact);
+        if (i > 0)
+            REQUIRE(chart[i - 1].value.minimax <= m.value.minimax);
+        State<size> s = root;
+        for (Move pv : m.pv)
+            s.play(pv);
+        s = root;
+        s.play(m.move);
+        if (s.terminal()) {
+            REQUIRE(m.value.minimax == s.board.minimax());
+            continue;
+        }
+        IterativeDeepening<size, AlphaBeta, Impl> cold;
+        cold.impl.endgame.max_empty = 0;
+        REQUIRE(cold.search(s).minimax == m.value.minimax);
+        cold_probes += cold.probe_count;
+    }
+    REQUIRE(ab.probe_count <= cold_probes);
+}
+
+TEST_CASE("solve at least", "[search]") {
+    constexpr int size = 7;
+    using Impl = conjectures::All<size, PV<size>>;
+    State<size> root;
+    for (int k : {-7, 1, 2, 3, 8}) {
+        IterativeDeepening<size, AlphaBeta, Impl> ab;
+        REQUIRE(ab.solve_at_least(root, k) == optional<bool>(2 >= k));
+    }
+
+    // one inequality takes fewer probes than the exact value
+    IterativeDeepening<size, AlphaBeta, Impl> exact, sign;
+    root.play(Move(BLACK, 2));
+    REQUIRE(exact.search(root).minimax == -2);
+    REQUIRE(sign.solve_at_least(root, 1) == optional<bool>(false));
+    REQUIRE(sign.probe_count <= exact.probe_count);
+
+    // a limit leaves the question open
+    IterativeDeepening<size, AlphaBeta, Impl> limited;
+    limited.limits.max_cutoff = 1;
+    REQUIRE(!limited.solve_at_least(root, -2));
+}
+
+// every threshold, against alpha-beta
+template <pos_t size> void check_dfpn(State<size> root) {
+    IterativeDeepening<size, AlphaBeta, conjectures::All<size, PV<size>>> ab;
+    int value = ab.search(root).minimax;
+    DFPN<size> dfpn;
+    dfpn.table_size = 1 << 16;
+    for (int k = -int(size); k <= int(size) + 1; k++)
+        REQUIRE(dfpn.solve_at_least(root, k) == optional<bool>(value >= k));
+}
+
+TEST_CASE("df-pn", "[search][dfpn]") {
+    check_dfpn(State<5>());
+    check_dfpn(State<6>());
+    State<7> root;
+    check_dfpn(root);
+    root.play(Move(BLACK, 2));
+    check_dfpn(root);
+    root.play(Move(WHITE, 3));
+    check_dfpn(root);
+}
+
+// every position reached by a game without captures, in every move order
+template <pos_t size>
+void check_tablebase(const Tablebase<size> &tb, State<size> &state, size_t &checked) {
+    if (state.terminal() || state.board.captured)
+        return;
+    if (optional<int> value = tb.probe(state)) {
+        REQUIRE(*value == exhaustive_minimax(state, -int(size), int(size)));
+        checked++;
+    }
+    pos_t legal = state.legal_moves(state.to_play) & ~state.capturing_moves(state.to_play);
+    for (pos_t i = 0; i < size; i++) {
+        if (legal & (1 << i)) {
+            state.play(Move(state.to_play, i));
+            check_tablebase(tb, state, checked);
+            state.undo();
+        }
+    }
+    if (state.game_state == State<size>::NORMAL) {
+        state.play(Move(state.to_play));
+        check_tablebase(tb, state, checked);
+        state.undo();
+    }
+}
+
+TEST_CASE("tablebase", "[search][tablebase]") {
+    constexpr int size = 5;
+    TablebaseGenerator<size> gen;
+    gen.threads = 2;
+    Tablebase<size> tb;
+    gen.generate(tb, size);
+    size_t known = std::count_if(tb.values.begin(), tb.values.end(),
+                                 [](int8_t v) { return v != Tablebase<size>::UNKNOWN; });
+    REQUIRE(known > 0);
+
+    std::string file = "tablebase.test.bin";
+    REQUIRE(tb.save(file));
+    Tablebase<size> loaded;
+    REQUIRE(loaded.load(file));
+    std::remove(file.c_str());
+    REQUIRE(loaded.values == tb.values);
+
+    size_t checked = 0;
+    State<size> root;
+    check_tablebase(tb, root, checked);
+    REQUIRE(checked > 0);
+
+    // BB.B. with white to play is worth 5 or -5 depending on the order of the stones
+    Board<size> board;
+    board.set(0, BLACK), board.set(1, BLACK), board.set(3, BLACK);
+    REQUIRE(tb.values[tb.index(board, WHITE)] == Tablebase<size>::UNKNOWN);
+
+    IterativeDeepening<size, AlphaBeta, conjectures::All<size, PV<size>>> ab;
+    ab.impl.tablebase = &tb;
+    int values[] = {-5, 0, 0, 0, -5};
+    for (pos_t i = 0; i < size; i++) {
+        root.play(Move(BLACK, i));
+        REQUIRE(ab.search(root).minimax == values[i]);
+        root.undo();
+    }
+}
+
+// every position of a game tree, one solver for all of them so that its table is reused across
+// histories
+template <pos_t size>
+void check_endgame(EndgameSolver<size> &solver, State<size> &state, size_t depth,
+                   size_t &checked) {
+    if (state.terminal())
+        return;
+    if (solver.applies(state)) {
+        int value = exhaustive_minimax(state, -int(size), int(size));
+        if (optional<int> v = solver.solve(state)) {
+            REQUIRE(*v == value);
+            checked++;
+        }
+        // null windows at the value and just above it
+        for (int k : {value, value + 1})
+            if (optional<int> v = solver.solve(state, k - 1, k))
+                REQUIRE((*v >= k) == (value >= k));
+    }
+    if (depth == 0)
+        return;
+    pos_t legal = state.legal_moves(state.to_play);
+    for (pos_t i = 0; i < size; i++) {
+        if (legal & (1 << i)) {
+            state.play(Move(state.to_play, i));
+            check_endgame(solver, state, depth - 1, checked);
+            state.undo();
+        }
+    }
+    state.play(Move(state.to_play));
+    check_endgame(solver, state, depth - 1, checked);
+    state.undo();
+}
+
+TEST_CASE("endgame solver", "[search][endgame]") {
+    EndgameSolver<5> solver;
+    solver.max_empty = 3;
+    State<5> root;
+    size_t checked = 0;
+    check_endgame(solver, root, 8, checked);
+    REQUIRE(checked > 0);
+    REQUIRE(solver.hits > 0);
+
+    // the searches hand off to it by default, and agree without it
+    State<7> state;
+    state.play(Move(BLACK, 3));
+    IterativeDeepening<7, AlphaBeta, conjectures::All<7, PV<7>>> with, without;
+    without.impl.endgame.max_empty = 0;
+    REQUIRE(with.search(state).minimax == without.search(state).minimax);
+    REQUIRE(with.impl.endgame.solved > 0);
+}
+
+// every position of the book, against a search without it
+template <pos_t size>
+void check_book(const OpeningBook<size> &book, State<size> &state, size_t plies,
+                size_t &checked) {
+    if (state.terminal())
+        return;
+    auto hit = book.probe(state);
+    REQUIRE(hit);
+    IterativeDeepening<size, AlphaBeta, conjectures::All<size, PV<size>>> ab;
+    REQUIRE(ab.search(state).minimax == hit->value);
+    state.play(hit->best);
+    REQUIRE((state.terminal() ? state.board.minimax() : ab.search(state).minimax) == hit->value);
+    state.undo();
+    checked++;
+    if (plies == 0)
+        return;
+    // the root moves of the search, all the moves after it
+    std::vector<Move> moves;
+    if (state.past.empty())
+        GoodPlayer<size>(state).moves(state.to_play, moves);
+    else {
+        pos_t legal = state.legal_moves(state.to_play);
+        for (pos_t i = 0; i < size; i++)
+            if (legal & (1 << i))
+                moves.emplace_back(state.to_play, i);
+        moves.emplace_back(state.to_play);
+    }
+    for (Move m : moves) {
+        state.play(m);
+        check_book(book, state, plies - 1, checked);
+        state.undo();
+    }
+}
+
+TEST_CASE("opening book", "[search][book]") {
+    constexpr int size = 6;
+    BookBuilder<size> builder;
+    builder.threads = 2;
+    OpeningBook<size> book;
+    builder.build(book, 2);
+
+    std::string file = "book.test.bin";
+    REQUIRE(book.save(file));
+    OpeningBook<size> loaded;
+    REQUIRE(loaded.load(file));
+    std::remove(file.c_str());
+    REQUIRE(loaded.plies == 2);
+    REQUIRE(loaded.entries.size() == book.entries.size());
+
+    State<size> root;
+    size_t checked = 0;
+    check_book(loaded, root, 2, checked);
+    // the mirror images share entries
+    REQUIRE(book.entries.size() < checked);
+
+    // positions in the book, and the position after a book move, take no probe
+    IterativeDeepening<size, AlphaBeta, conjectures::All<size, PV<size>>> ab, cold;
+    ab.book = &loaded;
+    REQUIRE(ab.search(root).minimax == cold.search(root).minimax);
+    REQUIRE(ab.probe_count == 0);
+    for (size_t i = 0; i < 3; i++)
+        root.play(loaded.probe(root)->best);
+    ab.probe_count = 0;
+    REQUIRE(ab.search(root).minimax == cold.search(root).minimax);
+    REQUIRE(ab.probe_count == 0);
+    // deeper positions are searched
+    root.play(Move(root.to_play));
+    REQUIRE(ab.search(root).minimax == cold.search(root).minimax);
+}
@@ -0,0 +1,139 @@
+#pragma once
+
+#include "lgo.hpp"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <string>
+
+// exact values and best moves of the positions in the first plies, written by gen_book. a position
+// is keyed by its board, player to move, passes and the set of boards in its history, which is all
+// its value depends on, so transpositions share an entry. a position and its mirror image share
+// one too, as GoodPlayer already prunes the mirror moves at the root.
+template <pos_t size> struct OpeningBook {
+    static constexpr char MAGIC[4] = {'L', 'G', 'O', 'B'};
+    static constexpr uint32_t VERSION = 1;
+    static constexpr int8_t PASS = -1;
+
+    struct Entry {
+        uint64_t key;
+        int8_t value;
+        int8_t move; // a position, or PASS. in the orientation of the smaller key
+        bool operator<(const Entry &o) const { return key < o.key; }
+    };
+    struct Hit {
+        int value;
+        Move best;
+    };
+
+    std::vector<Entry> entries; // sorted by key
+    uint32_t plies = 0;         // the positions up to this many plies are in the book
+
+    static uint64_t mix(uint64_t x) {
+        x ^= x >> 33;
+        x *= 0xff51afd7ed558ccdull;
+        x ^= x >> 33;
+        x *= 0xc4ceb9fe1a85ec53ull;
+        return x ^ x >> 33;
+    }
+    static Board<size> mirror(Board<size> board) {
+        Board<size> m;
+        for (pos_t p = 0; p < size; p++)
+            m.set(size - 1 - p, board.get(p));
+        return m;
+    }
+    static uint64_t key(const State<size> &state, bool mirrored) {
+        auto orient = [&](Board<size> b) { return (mirrored ? mirror(b) : b).board; };
+        // every board of the history was the current one at some point
+        std::vector<pos_t> seen{state.board.board};
+        for (auto past = state.past; !past.empty(); past.pop())
+            seen.push_back(std::get<1>(past.top()).board);
+        std::sort(seen.begin(), seen.end());
+        seen.erase(std::unique(seen.begin(), seen.end()), seen.end());
+        uint64_t history = 0;
+        for (pos_t b : seen) {
+            Board<size> board;
+            board.board = b;
+            if (state.history.contains(board))
+                history += mix(orient(board) + 1);
+        }
+        return mix(mix(orient(state.board) * 6 + state.game_state * 2 +
+                             (state.to_play == WHITE)) ^
+                      history);
+    }
+    // the key of whichever orientation has the smaller one, and whether it is the mirror image
+    static std::pair<uint64_t, bool> canonical(const State<size> &state) {
+        uint64_t k = key(state, false), m = key(state, true);
+        return m < k ? std::make_pair(m, true) : std::make_pair(k, false);
+    }
+
+    optional<Hit> probe(const State<size> &state) const {
+        if (entries.empty() || state.terminal())
+            return {};
+        auto c = canonical(state);
+        Entry target{c.first, 0, 0};
+        auto it = std::lower_bound(entries.begin(), entries.end(), target);
+        if (it == entries.end() || it->key != c.first)
+            return {};
+        if (it->move == PASS)
+            return Hit{it->value, Move(state.to_play)};
+        pos_t p = pos_t(it->move);
+        return Hit{it->value, Move(state.to_play, c.second ? size - 1 - p : p)};
+    }
+    void add(const State<size> &state, int value, Move best) {
+        auto c = canonical(state);
+        int8_t move = best.is_pass ? PASS : int8_t(c.second ? size - 1 - best.position
+                                                            : best.position);
+        entries.push_back(Entry{c.first, int8_t(value), move});
+    }
+    // a position reached at several plies is kept once
+    void sort() {
+        std::sort(entries.begin(), entries.end());
+        auto same = [](const Entry &a, const Entry &b) { return a.key == b.key; };
+        entries.erase(std::unique(entries.begin(), entries.end(), same), entries.end());
+    }
+
+    bool load(const std::string &filename) {
+        std::ifstream in(filename, std::ios::binary);
+        char magic[4];
+        uint32_t version, file_size, file_plies;
+        uint64_t count;
+        if (!in.read(magic, 4) || std::memcmp(magic, MAGIC, 4) != 0)
+            return false;
+        in.read(reinterpret_cast<char *>(&version), sizeof(version));
+        in.read(reinterpret_cast<char *>(&file_size), sizeof(file_size));
+        in.read(reinterpret_cast<char *>(&file_plies), sizeof(file_plies));
+        in.read(reinterpret_cast<char *>(&count), sizeof(count));
+        if (!in || version != VERSION || file_size != size)
+            return false;
+        std::vector<Entry> e(count);
+        for (Entry &entry : e) {
+            in.read(reinterpret_cast<char *>(&entry.key), sizeof(entry.key));
+            in.read(reinterpret_cast<char *>(&entry.value), sizeof(entry.value));
+            in.read(reinterpret_cast<char *>(&entry.move), sizeof(entry.move));
+        }
+        if (!in)
+            return false;
+        entries = std::move(e);
+        plies = file_plies;
+        return true;
+    }
+    // ten bytes an entry
+    bool save(const std::string &filename) const {
+        std::ofstream out(filename, std::ios::binary | std::ios::trunc);
+        uint32_t version = VERSION, file_size = size;
+        uint64_t count = entries.size();
+        out.write(MAGIC, 4);
+        out.write(reinterpret_cast<const char *>(&version), sizeof(version));
+        out.write(reinterpret_cast<const char *>(&file_size), sizeof(file_size));
+        out.write(reinterpret_cast<const char *>(&plies), sizeof(plies));
+        out.write(reinterpret_cast<const char *>(&count), sizeof(count));
+        for (const Entry &entry : entries) {
+            out.write(reinterpret_cast<const char *>(&entry.key), sizeof(entry.key));
+            out.write(reinterpret_cast<const char *>(&entry.value), sizeof(entry.value));
+            out.write(reinterpret_cast<const char *>(&entry.move), sizeof(entry.move));
+        }
+        return bool(out);
+    }
+};
+template <pos_t size> constexpr char OpeningBook<size>::MAGIC[4];
@@ -0,0 +1,83 @@
+#pragma once
+
+#include "lgo.hpp"
+#include <array>
+
+// proven bounds on the final score of a position, derived only from the board.
+template <pos_t size> struct StaticBounds {
+    // returns a bitset of cells which score for color at the end of the game however the opponent
+    // plays, provided color never fills its own eyes. these are the stones of unconditionally
+    // alive chains (benson's algorithm, which is simple in one dimension since every chain borders
+    // at most two regions) and the one cell eyes which only they border. the opponent can never
+    // enter such an eye: it would be suicide since each bordering chain keeps its other eye.
+    static pos_t safe_cells(const Board<size> &board, Cell color) {
+        struct Chain {
+            pos_t start, end; // [start, end)
+            bool alive;
+        };
+        std::array<Chain, size / 2 + 1> chains;
+        size_t num_chains = 0;
+        for (pos_t i = 0; i < size;) {
+            if (board.get(i) != color) {
+                i++;
+                continue;
+            }
+            pos_t j = i;
+            while (j < size && board.get(j) == color)
+                j++;
+            // chains touching an edge border only one region, so they can never have two eyes
+            chains[num_chains++] = Chain{i, j, i != 0 && j != size};
+            i = j;
+        }
+
+        // a region is vital to the chain at `end` if its only empty cell is adjacent to the chain
+        // and its far side is the edge or another alive chain
+        auto vital = [&](pos_t near, int dir, const Chain *far) {
+            if (!board.get(near).is_empty())
+                return false;
+            pos_t limit = far ? (dir < 0 ? far->end - 1 : far->start) : (dir < 0 ? -1 : size);
+            for (pos_t i = near + dir; i != limit; i += dir)
+                if (board.get(i) != color.flip())
+                    return false;
+            return !far || far->alive;
+        };
+        bool changed = true;
+        while (changed) {
+            changed = false;
+            for (size_t c = 0; c < num_chains; c++) {
+                Chain &chain = chains[c];
+                if (!chain.alive)
+                    continue;
+                const Chain *left = c > 0 ? &chains[c - 1] : nullptr;
+                const Chain *right = c + 1 < num_chains ? &chains[c + 1] : nullptr;
+                if (!vital(chain.start - 1, -1, left) || !vital(chain.end, 1, right)) {
+                    chain.alive = false;
+                    changed = true;
+                }
+            }
+        }
+
+        pos_t safe = 0;
+        for (size_t c = 0; c < num_chains; c++) {
+            const Chain &chain = chains[c];
+            if (!chain.alive)
+                continue;
+            safe |= ((1_pos_t << chain.end) - 1) ^ ((1_pos_t << chain.start) - 1);
+            // an eye with no opponent stones inside stays empty and scores for color
+            pos_t left = chain.start - 1, right = chain.end;
+            if (left == 0 || board.get(left - 1) == color)
+                safe |= 1_pos_t << left;
+            if (right == size - 1 || board.get(right + 1) == color)
+                safe |= 1_pos_t << right;
+        }
+        return safe;
+    }
+
+    // black ends with at least its safe cells and white with at most the remainder
+    static int lower(const Board<size> &board) {
+        return 2 * __builtin_popcount(safe_cells(board, BLACK)) - int(size);
+    }
+    static int upper(const Board<size> &board) {
+        return int(size) - 2 * __builtin_popcount(safe_cells(board, WHITE));
+    }
+};
@@ -0,0 +1,107 @@
+#include "cmdparser.hpp"
+#include "conjectures.hpp"
+#include "dfpn.hpp"
+#include <iomanip>
+#include <iostream>
+#include <random>
+
+// times df-pn against iterative deepening alpha-beta on threshold questions, "is the value at
+// least k?", on boards of size 7 to 10. the positions are the empty board and the ends of a few
+// random games, cut off once they have had a capture so that the rest of the game is an ending.
+// each engine gets the same time limit per question and starts with empty tables.
+
+struct Row {
+    std::string position;
+    int k;
+    optional<bool> answer[2];
+    double seconds[2];
+    size_t nodes[2];
+};
+
+template <pos_t size> std::vector<State<size>> positions(size_t count, unsigned seed) {
+    std::vector<State<size>> result{State<size>()};
+    std::mt19937 rng(seed);
+    while (result.size() < count + 1) {
+        State<size> state;
+        bool captured = false;
+        for (size_t plies = 0; !state.terminal() && plies < 4 * size && !captured; plies++) {
+            pos_t legal = state.legal_moves(state.to_play);
+            std::vector<Move> moves;
+            for (pos_t i = 0; i < size; i++)
+                if (legal & (1 << i))
+                    moves.emplace_back(state.to_play, i);
+            if (moves.empty())
+                break;
+            Move m = moves[rng() % moves.size()];
+            captured = state.capturing_moves(state.to_play) & (1 << m.position);
+            state.play(m);
+        }
+        if (captured && !state.terminal())
+            result.push_back(state);
+    }
+    return result;
+}
+
+template <pos_t size> void compare(size_t count, double seconds, unsigned seed) {
+    using Impl = conjectures::All<size, PV<size>>;
+    auto limit = std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+        std::chrono::duration<double>(seconds));
+    for (State<size> &state : positions<size>(count, seed)) {
+        // does black win?
+        Row row;
+        std::stringstream ss;
+        ss << state.board << (state.to_play == BLACK ? " b" : " w");
+        row.position = ss.str();
+        row.k = 1;
+        for (int engine = 0; engine < 2; engine++) {
+            auto start = std::chrono::steady_clock::now();
+            if (engine == 0) {
+                IterativeDeepening<size, AlphaBeta, Impl> ab;
+                ab.verbose = false;
+                ab.limits.time = limit;
+                row.answer[0] = ab.solve_at_least(state, row.k);
+                row.nodes[0] = ab.limits.nodes_searched;
+            } else {
+                DFPN<size> dfpn;
+                SearchLimits limits;
+                limits.time = limit;
+                limits.begin();
+                dfpn.limits = &limits;
+                row.answer[1] = dfpn.solve_at_least(state, row.k);
+                row.nodes[1] = dfpn.node_count;
+            }
+            row.seconds[engine] =
+                std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        }
+        std::cout << std::setw(2) << size << "  " << std::left << std::setw(14) << row.position
+                  << std::right << " >= " << std::setw(2) << row.k;
+        for (int engine = 0; engine < 2; engine++) {
+            const char *answer = !row.answer[engine] ? "?" : *row.answer[engine] ? "yes" : "no";
+            std::cout << "  " << std::setw(3) << answer << std::setw(9) << std::fixed
+                      << std::setprecision(2) << row.seconds[engine] << "s" << std::setw(11)
+                      << row.nodes[engine];
+        }
+        if (row.answer[0] && row.answer[1] && *row.answer[0] != *row.answer[1])
+            std::cout << "  MISMATCH";
+        std::cout << std::endl;
+    }
+}
+
+int main(int argc, char **argv) {
+    cli::Parser parser(argc, argv);
+    parser.set_optional<int>("n", "positions", 3, "Random endings per size");
+    parser.set_optional<double>("s", "seconds", 60, "Time limit per engine and question");
+    parser.set_optional<int>("r", "seed", 1, "Seed for the random games");
+    parser.run_and_exit_if_error();
+
+    size_t count = std::max(0, parser.get<int>("n"));
+    double seconds = parser.get<double>("s");
+    unsigned seed = parser.get<int>("r");
+    std::cout << "size position        k      alpha-beta  seconds      nodes"
+                 "   df-pn  seconds      nodes"
+              << std::endl;
+    compare<7>(count, seconds, seed);
+    compare<8>(count, seconds, seed);
+    compare<9>(count, seconds, seed);
+    compare<10>(count, seconds, seed);
+}
@@ -1,3 +1,5 @@
+#pragma once
+
 #include "conjectures/full.hpp"
 #include "conjectures/stability.hpp"
 #include "conjectures/telomere.hpp"
@@ -0,0 +1,148 @@
+#pragma once
+
+#include "ab.hpp"
+#include <cstdint>
+
+// depth-first proof number search (nagai's df-pn) for threshold questions: is the value of a
+// position at least k? black's nodes are OR nodes and white's AND nodes, and the search always
+// expands the most proving node below the root within thresholds on its proof and disproof
+// numbers, so it follows narrow forcing lines far deeper than a full width search would.
+//
+// superko makes the value of a position depend on the boards seen before it. a table keyed by the
+// board alone would let a proof found under one history be reused under another, the graph
+// history interaction. here the set of earlier boards is part of the key, so positions with
+// different histories never share an entry. positions with the same history reached by different
+// move orders still do. since superko never repeats a board, the graph searched has no cycles.
+template <pos_t size> struct DFPN {
+    static constexpr uint32_t INF = UINT32_MAX / 2;
+    // 16 bytes, a key collision could mix up two positions but with 64 bit keys it is negligible
+    struct Entry {
+        uint64_t key = 0;
+        uint32_t pn = 1, dn = 1;
+    };
+    std::vector<Entry> table;
+    size_t table_size = 1 << 22;
+    SearchLimits *limits = nullptr;
+    size_t node_count = 0;
+    int k = 0;
+
+    // whether the value of state is at least k, unset if a limit ran out first
+    optional<bool> solve_at_least(State<size> &state, int threshold) {
+        if (table.size() != table_size)
+            table.assign(table_size, Entry());
+        k = threshold;
+        node_count = 0;
+        uint64_t history = 0;
+        state.history.for_each([&](Board<size> b) { history ^= murmur(b.board + 1); });
+        uint32_t pn, dn;
+        numbers(state, history, pn, dn);
+        while (pn != 0 && dn != 0) {
+            if (limits && limits->hit())
+                return {};
+            std::tie(pn, dn) = mid(state, history, INF, INF);
+        }
+        return pn == 0;
+    }
+
+    void clear() { table.assign(table_size, Entry()); }
+
+    uint64_t key(const State<size> &state, uint64_t history) const {
+        uint64_t position = uint64_t(state.board.board) << 8 | uint64_t(state.game_state) << 4 |
+                            state.to_play.value;
+        uint64_t h = murmur(history ^ murmur(position) ^ murmur(uint64_t(k + 2 * size) << 32));
+        return h ? h : 1;
+    }
+
+    // a finished game or the static bounds settle a position without search
+    bool settled(const State<size> &state, uint32_t &pn, uint32_t &dn) const {
+        int lower, upper;
+        if (state.terminal()) {
+            lower = upper = state.board.minimax();
+        } else {
+            lower = StaticBounds<size>::lower(state.board);
+            upper = StaticBounds<size>::upper(state.board);
+        }
+        if (lower >= k)
+            pn = 0, dn = INF;
+        else if (upper < k)
+            pn = INF, dn = 0;
+        else
+            return false;
+        return true;
+    }
+
+    void numbers(const State<size> &state, uint64_t history, uint32_t &pn, uint32_t &dn) const {
+        if (settled(state, pn, dn))
+            return;
+        uint64_t h = key(state, history);
+        const Entry &e = table[h % table.size()];
+        if (e.key == h)
+            pn = e.pn, dn = e.dn;
+        else
+            pn = dn = 1;
+    }
+
+    // solved entries are kept over unsolved ones, which are cheap to find again
+    void store(const State<size> &state, uint64_t history, uint32_t pn, uint32_t dn) {
+        uint64_t h = key(state, history);
+        Entry &e = table[h % table.size()];
+        if (e.key != h && (e.pn == 0 || e.dn == 0) && pn != 0 && dn != 0)
+            return;
+        e.key = h, e.pn = pn, e.dn = dn;
+    }
+
+    // expands state until its proof or disproof number reaches its threshold, returns both. the
+    // numbers of the children are kept here as well as in the table, where a child's entry may be
+    // replaced before its parent looks again.
+    std::pair<uint32_t, uint32_t> mid(State<size> &state, uint64_t history, uint32_t thpn,
+                                      uint32_t thdn) {
+        node_count++;
+        if (limits && node_count % SearchLimits::NODE_BATCH == 0)
+            limits->tick();
+        bool black = state.to_play == BLACK;
+        std::vector<Move> moves;
+        GoodPlayer<size>(state).moves(state.to_play, moves);
+        std::vector<uint64_t> histories(moves.size());
+        std::vector<std::pair<uint32_t, uint32_t>> children(moves.size());
+        for (size_t i = 0; i < moves.size(); i++) {
+            state.play(moves[i]);
+            histories[i] = moves[i].is_pass ? history : history ^ murmur(state.board.board + 1);
+            numbers(state, histories[i], children[i].first, children[i].second);
+            state.undo();
+        }
+
+        while (true) {
+            // an OR node takes the smallest proof number and sums the disproof numbers, an AND
+            // node the other way round. "first" is the number the node minimizes over children.
+            uint64_t sum = 0;
+            uint32_t best = INF + 1, second = INF + 1, best_other = 0;
+            size_t best_index = 0;
+            for (size_t i = 0; i < moves.size(); i++) {
+                uint32_t pn = children[i].first, dn = children[i].second;
+                uint32_t first = black ? pn : dn, other = black ? dn : pn;
+                sum = std::min<uint64_t>(sum + other, INF);
+                if (first < best) {
+                    second = best;
+                    best = first, best_other = other, best_index = i;
+                } else if (first < second) {
+                    second = first;
+                }
+            }
+            uint32_t pn = black ? best : uint32_t(sum), dn = black ? uint32_t(sum) : best;
+            if (pn >= thpn || dn >= thdn || (limits && limits->hit())) {
+                store(state, history, pn, dn);
+                return {pn, dn};
+            }
+            // the best child may use up the node's threshold, or until it falls behind the second
+            // best. its other number may grow by what the node's sum has left.
+            uint32_t thfirst = black ? thpn : thdn, thother = black ? thdn : thpn;
+            uint32_t child_first = std::min<uint64_t>(thfirst, uint64_t(second) + 1);
+            uint32_t child_other = std::min<uint64_t>(INF, uint64_t(thother) - sum + best_other);
+            state.play(moves[best_index]);
+            children[best_index] =
+                black ? mid(state, histories[best_index], child_first, child_other)
+                      : mid(state, histories[best_index], child_other, child_first);
+            state.undo();
+        }
+    }
+};
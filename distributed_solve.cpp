@@ -0,0 +1,338 @@
+#include "ab.hpp"
+#include "cmdparser.hpp"
+#include "conjectures.hpp"
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <sys/wait.h>
+#include <thread>
+#include <unistd.h>
+
+// solves a position by splitting the tree at a fixed depth into independent jobs. the coordinator
+// expands the tree from the root, writes every frontier position with its alpha-beta window to a
+// spool directory, and backs up the results as they arrive. as bounds improve the windows of
+// waiting jobs are narrowed, and jobs which can no longer change the root are withdrawn. workers
+// are forked locally, but any process running `distributed_solve --worker` on the same spool
+// directory (e.g. over a shared filesystem) takes jobs too.
+//
+// spool layout: jobs/ holds waiting jobs, which a worker claims by renaming into running/. the
+// result goes to results/ under the job's name. a file in cancel/ with a running job's name
+// abandons it, and a file named stop ends all workers. files are written in tmp/ and renamed into
+// place so nobody reads a partial file.
+
+namespace fs = std::filesystem;
+
+constexpr pos_t size = 11;
+
+std::string format_moves(const std::vector<Move> &moves) {
+    std::string s;
+    for (Move m : moves) {
+        if (!s.empty())
+            s += " ";
+        std::stringstream ss;
+        if (m.is_pass)
+            ss << (m.color == BLACK ? "b" : "w") << "p";
+        else
+            ss << (m.color == BLACK ? "b" : "w") << m.position + 1;
+        s += ss.str();
+    }
+    return s;
+}
+
+// moves in the form {color}{position} as in ab, or {color}p for a pass
+State<size> parse_moves(std::istream &in, std::vector<Move> *path = nullptr) {
+    State<size> state;
+    std::string move;
+    while (in >> move) {
+        Cell color = tolower(move[0]) == 'b' ? BLACK : WHITE;
+        Move m = tolower(move[1]) == 'p' ? Move(color) : Move(color, std::stoi(move.substr(1)) - 1);
+        state.play(m);
+        if (path)
+            path->push_back(m);
+    }
+    return state;
+}
+
+void write_file(const fs::path &spool, const fs::path &dest, const std::string &contents) {
+    fs::path tmp = spool / "tmp" / (dest.filename().string() + "." + std::to_string(getpid()));
+    {
+        std::ofstream out(tmp);
+        out << contents;
+    }
+    fs::rename(tmp, dest);
+}
+
+// a job file holds the window on its first line and the moves from the empty board on the second.
+// a result file holds the value and whether it is exact, an upper bound or a lower bound.
+int worker(const fs::path &spool) {
+    using Impl = conjectures::All<size, PV<size>>;
+    IterativeDeepening<size, AlphaBeta, Impl> ab;
+    std::freopen((spool / ("worker." + std::to_string(getpid()) + ".log")).c_str(), "w", stdout);
+    while (!fs::exists(spool / "stop")) {
+        std::string name;
+        for (auto &entry : fs::directory_iterator(spool / "jobs")) {
+            std::error_code ec;
+            fs::rename(entry.path(), spool / "running" / entry.path().filename(), ec);
+            if (!ec) {
+                name = entry.path().filename().string();
+                break;
+            }
+        }
+        if (name.empty()) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(50));
+            continue;
+        }
+
+        std::ifstream in(spool / "running" / name);
+        int alpha, beta;
+        in >> alpha >> beta;
+        State<size> state = parse_moves(in);
+        std::cout << "job " << name << std::endl;
+
+        std::atomic<bool> finished{false};
+        std::thread watcher([&] {
+            while (!finished) {
+                if (fs::exists(spool / "stop") || fs::exists(spool / "cancel" / name))
+                    ab.limits.stop = true;
+                std::this_thread::sleep_for(std::chrono::milliseconds(100));
+            }
+        });
+        auto val = ab.search(state, alpha, beta);
+        finished = true;
+        watcher.join();
+        bool cancelled = ab.limits.stop;
+        ab.limits.stop = false;
+
+        // iterative deepening clips its result to the window, so the value on an edge is a bound
+        if (!cancelled && val.exact) {
+            const char *type = val.minimax <= alpha ? "upper" : val.minimax >= beta ? "lower"
+                                                                                    : "exact";
+            write_file(spool, spool / "results" / name,
+                       std::to_string(val.minimax) + " " + type + "\n");
+        }
+        std::error_code ec;
+        fs::remove(spool / "running" / name, ec);
+        fs::remove(spool / "cancel" / name, ec);
+    }
+    return 0;
+}
+
+struct Coordinator {
+    struct Node {
+        std::vector<Move> path;
+        Cell to_play = EMPTY;
+        int lo = -int(size), hi = size; // proven bounds on the value
+        std::vector<size_t> children;
+        bool leaf = false;
+        // the outstanding job of a leaf, if any
+        std::string job;
+        int job_alpha = 0, job_beta = 0;
+        size_t generation = 0;
+    };
+
+    fs::path spool;
+    std::vector<Node> nodes;
+    size_t jobs_written = 0, jobs_withdrawn = 0, results_read = 0;
+
+    size_t expand(State<size> &state, std::vector<Move> &path, size_t depth) {
+        size_t index = nodes.size();
+        nodes.emplace_back();
+        nodes[index].path = path;
+        nodes[index].to_play = state.to_play;
+        if (state.terminal()) {
+            nodes[index].lo = nodes[index].hi = state.board.minimax();
+            return index;
+        }
+        if (depth == 0) {
+            nodes[index].leaf = true;
+            return index;
+        }
+        std::vector<Move> moves;
+        Minimax<size>().gen_moves(state, moves);
+        for (Move m : moves) {
+            state.play(m);
+            path.push_back(m);
+            size_t child = expand(state, path, depth - 1);
+            nodes[index].children.push_back(child);
+            path.pop_back();
+            state.undo();
+        }
+        return index;
+    }
+
+    void backup(size_t index) {
+        Node &n = nodes[index];
+        if (n.children.empty())
+            return;
+        bool black = n.to_play == BLACK;
+        n.lo = n.hi = black ? -int(size) : size;
+        for (size_t c : n.children) {
+            backup(c);
+            const Node &child = nodes[c];
+            n.lo = black ? std::max(n.lo, child.lo) : std::min(n.lo, child.lo);
+            n.hi = black ? std::max(n.hi, child.hi) : std::min(n.hi, child.hi);
+        }
+    }
+
+    static bool settled(const Node &n, int alpha, int beta) {
+        return n.lo == n.hi || n.hi <= alpha || n.lo >= beta;
+    }
+
+    // a child only matters where it could beat the best its siblings already guarantee, which
+    // narrows its window. leaves are (re)issued or withdrawn to match their window.
+    void schedule(size_t index, int alpha, int beta) {
+        Node &n = nodes[index];
+        if (n.leaf) {
+            bool needed = alpha < beta && !settled(n, alpha, beta);
+            if (!n.job.empty() && (!needed || alpha != n.job_alpha || beta != n.job_beta))
+                withdraw(n, needed);
+            if (needed && n.job.empty())
+                issue(index, alpha, beta);
+            return;
+        }
+        for (size_t c : n.children) {
+            int a = alpha, b = beta;
+            for (size_t s : n.children) {
+                if (s == c)
+                    continue;
+                if (n.to_play == BLACK)
+                    a = std::max(a, nodes[s].lo);
+                else
+                    b = std::min(b, nodes[s].hi);
+            }
+            schedule(c, a, b);
+        }
+    }
+
+    void issue(size_t index, int alpha, int beta) {
+        Node &n = nodes[index];
+        n.job = std::to_string(index) + "." + std::to_string(n.generation++);
+        n.job_alpha = alpha;
+        n.job_beta = beta;
+        write_file(spool, spool / "jobs" / n.job,
+                   std::to_string(alpha) + " " + std::to_string(beta) + "\n" +
+                       format_moves(n.path) + "\n");
+        jobs_written++;
+    }
+
+    // a waiting job is taken back. one already running is cancelled if it is no longer needed at
+    // all, otherwise left to finish since any result still bounds the leaf.
+    void withdraw(Node &n, bool needed) {
+        std::error_code ec;
+        fs::rename(spool / "jobs" / n.job, spool / "tmp" / n.job, ec);
+        if (!ec) {
+            fs::remove(spool / "tmp" / n.job);
+            n.job.clear();
+            jobs_withdrawn++;
+        } else if (!needed) {
+            write_file(spool, spool / "cancel" / n.job, "");
+            n.job.clear();
+        }
+    }
+
+    // folds every result in, returns whether any arrived
+    bool collect() {
+        bool any = false;
+        for (auto &entry : fs::directory_iterator(spool / "results")) {
+            std::string name = entry.path().filename().string();
+            size_t index = std::stoul(name.substr(0, name.find('.')));
+            std::ifstream in(entry.path());
+            int value;
+            std::string type;
+            if (!(in >> value >> type) || index >= nodes.size())
+                continue;
+            Node &n = nodes[index];
+            if (type != "upper")
+                n.lo = std::max(n.lo, value);
+            if (type != "lower")
+                n.hi = std::min(n.hi, value);
+            if (n.job == name)
+                n.job.clear();
+            fs::remove(entry.path());
+            results_read++;
+            any = true;
+        }
+        return any;
+    }
+};
+
+int main(int argc, char **argv) {
+    cli::Parser parser(argc, argv);
+    parser.set_optional<std::string>("s", "spool", "spool", "Directory shared with the workers");
+    parser.set_optional<int>("d", "depth", 4, "Depth at which the tree is split into jobs");
+    parser.set_optional<int>("j", "workers", std::max(1u, std::thread::hardware_concurrency()),
+                             "Number of local worker processes");
+    parser.set_optional<int>("a", "alpha", -size, "Initial alpha value");
+    parser.set_optional<int>("b", "beta", size, "Initial beta value");
+    parser.set_optional<bool>("w", "worker", false, "Only take jobs from the spool directory");
+    parser.set_optional<std::vector<std::string>>(
+        "", "state", std::vector<std::string>(),
+        "Moves in the form {color}{position}, where color is b or w");
+    parser.run_and_exit_if_error();
+
+    fs::path spool = parser.get<std::string>("s");
+    if (parser.get<bool>("w"))
+        return worker(spool);
+
+    for (const char *dir : {"jobs", "running", "results", "tmp", "cancel"}) {
+        fs::remove_all(spool / dir);
+        fs::create_directories(spool / dir);
+    }
+    fs::remove(spool / "stop");
+
+    std::stringstream ss;
+    for (const std::string &move : parser.get<std::vector<std::string>>(""))
+        ss << move << " ";
+    Coordinator c;
+    c.spool = spool;
+    std::vector<Move> path;
+    State<size> root = parse_moves(ss, &path);
+    c.expand(root, path, parser.get<int>("d"));
+    size_t leaves = 0;
+    for (auto &n : c.nodes)
+        leaves += n.leaf;
+    std::cout << "split " << root.board << " into " << leaves << " leaves of "
+              << c.nodes.size() << " nodes" << std::endl;
+
+    std::vector<pid_t> workers;
+    for (int i = 0; i < parser.get<int>("j"); i++) {
+        pid_t pid = fork();
+        if (pid == 0)
+            return worker(spool);
+        workers.push_back(pid);
+    }
+
+    int alpha = parser.get<int>("a"), beta = parser.get<int>("b");
+    auto start = std::chrono::steady_clock::now();
+    int last_lo = alpha - 1, last_hi = beta + 1;
+    while (true) {
+        c.collect();
+        c.backup(0);
+        const auto &r = c.nodes[0];
+        if (r.lo != last_lo || r.hi != last_hi) {
+            std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+            std::cout << "[" << elapsed.count() << "s] root in [" << r.lo << ", " << r.hi
+                      << "], " << c.results_read << " results" << std::endl;
+            last_lo = r.lo, last_hi = r.hi;
+        }
+        if (Coordinator::settled(r, alpha, beta))
+            break;
+        c.schedule(0, alpha, beta);
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    }
+    write_file(spool, spool / "stop", "");
+    for (pid_t pid : workers)
+        waitpid(pid, nullptr, 0);
+
+    const auto &r = c.nodes[0];
+    std::cout << root.board << " minimax ";
+    if (r.lo == r.hi)
+        std::cout << r.lo;
+    else if (r.hi <= alpha)
+        std::cout << "<= " << r.hi;
+    else
+        std::cout << ">= " << r.lo;
+    std::cout << " (" << c.jobs_written << " jobs written, " << c.jobs_withdrawn
+              << " withdrawn)" << std::endl;
+}
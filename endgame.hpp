@@ -0,0 +1,187 @@
+#pragma once
+
+#include "lgo.hpp"
+#include <algorithm>
+#include <vector>
+
+// values of positions with few empty cells, for the searches to hand off. the subgame is searched
+// by a plain alpha-beta, without the move generation, conjectures and bookkeeping of AlphaBeta,
+// and its bounds are cached. captures can make the subgame grow, so it is given up past a budget.
+//
+// the value of a position also depends on its history, but only through the boards its subgame
+// looks up. a cached value keeps those lookups together with their answers, and is reused by any
+// position with the same board whose history answers them the same way. lookups of boards played
+// inside the subgame are answered by the subgame itself and are not kept.
+template <pos_t size> struct EndgameSolver {
+    struct Lookup {
+        pos_t board;
+        bool seen;
+    };
+    struct Entry {
+        pos_t board = 0;
+        uint8_t to_play = 0, game_state = 0;
+        int8_t lower = 0, upper = 0; // bounds on the value
+        bool used = false, given_up = false;
+        std::vector<Lookup> lookups;
+    };
+
+    pos_t max_empty = 4;        // positions with more empty cells are left to the caller, 0 is off
+    size_t max_nodes = 256;     // a subgame which grows through captures is given up
+    size_t table_size = 1 << 14;
+    size_t solved = 0, given_up = 0, hits = 0, node_count = 0;
+
+    bool applies(const State<size> &state) const {
+        return max_empty && !state.terminal() &&
+               pos_t(__builtin_popcount(state.board.empty_set())) <= max_empty;
+    }
+
+    // the fail-soft value in the window if the position applies and its subgame is small enough
+    optional<int> solve(const State<size> &state, int alpha = -int(size) - 1,
+                        int beta = int(size) + 1) {
+        if (!applies(state) || alpha >= beta)
+            return {};
+        if (table.empty())
+            table.resize(table_size);
+        root = &state;
+        path.clear();
+        budget = max_nodes;
+        std::vector<Lookup> lookups;
+        optional<int> value =
+            search(state.board, state.to_play, state.game_state, alpha, beta, lookups);
+        if (value) {
+            solved++;
+            return value;
+        }
+        // the same subgame would likely grow as large again, whatever the history
+        given_up++;
+        Entry &e = slot(state.board, state.to_play, state.game_state);
+        e.used = e.given_up = true;
+        e.board = state.board.board;
+        e.to_play = state.to_play.value;
+        e.game_state = state.game_state;
+        e.lookups.clear();
+        return {};
+    }
+
+    void clear() {
+        table.clear();
+        solved = given_up = hits = node_count = 0;
+    }
+
+  private:
+    typedef typename State<size>::GameState GameState;
+
+    std::vector<Entry> table;
+    const State<size> *root = nullptr;
+    std::vector<pos_t> path; // boards played since the root, which its history does not have
+    size_t budget = 0;
+
+    bool seen(pos_t board) const {
+        if (std::find(path.begin(), path.end(), board) != path.end())
+            return true;
+        Board<size> b;
+        b.board = board;
+        return root->history.contains(b);
+    }
+
+    Entry &slot(const Board<size> &board, Cell to_play, GameState game_state) {
+        uint64_t h = ((uint64_t(board.board) * 3 + game_state) * 2 + (to_play == WHITE)) *
+                     0x9e3779b97f4a7c15ull;
+        return table[(h ^ h >> 32) % table.size()];
+    }
+
+    static void merge(std::vector<Lookup> &into, const std::vector<Lookup> &from, pos_t board) {
+        for (const Lookup &l : from) {
+            auto same = [&](const Lookup &o) { return o.board == l.board; };
+            if (l.board != board && std::none_of(into.begin(), into.end(), same))
+                into.push_back(l);
+        }
+    }
+
+    optional<int> search(const Board<size> &board, Cell to_play, GameState game_state, int alpha,
+                         int beta, std::vector<Lookup> &lookups) {
+        if (game_state == State<size>::GAME_OVER)
+            return board.minimax();
+        Entry &e = slot(board, to_play, game_state);
+        if (e.used && e.board == board.board && e.to_play == to_play.value &&
+            e.game_state == game_state &&
+            std::all_of(e.lookups.begin(), e.lookups.end(),
+                        [&](const Lookup &l) { return seen(l.board) == l.seen; })) {
+            if (e.given_up)
+                return {};
+            if (e.lower >= beta || e.upper <= alpha || e.lower == e.upper) {
+                hits++;
+                lookups = e.lookups;
+                return int(e.lower >= beta ? e.lower : e.upper);
+            }
+        }
+        if (!budget--)
+            return {};
+        node_count++;
+
+        // captures first, then the other moves. the pass comes last, except after a pass, where it
+        // ends the game and is cheap to try first.
+        bool black = to_play == BLACK;
+        int best = black ? -int(size) - 1 : int(size) + 1, a = alpha, b = beta;
+        std::vector<Lookup> child;
+        auto visit = [&](optional<int> v) {
+            if (!v)
+                return false;
+            merge(lookups, child, board.board);
+            if (black)
+                best = std::max(best, *v), a = std::max(a, best);
+            else
+                best = std::min(best, *v), b = std::min(b, best);
+            return true;
+        };
+        GameState after_pass = game_state == State<size>::NORMAL ? State<size>::PASS
+                                                                 : State<size>::GAME_OVER;
+        auto pass = [&] {
+            child.clear();
+            return visit(search(board, to_play.flip(), after_pass, a, b, child));
+        };
+        if (after_pass == State<size>::GAME_OVER && !pass())
+            return {};
+
+        pos_t empty = board.empty_set(), capturing = 0;
+        Board<size> after[size];
+        for (pos_t p = 0; p < size; p++) {
+            if (!(empty & 1 << p))
+                continue;
+            after[p] = board;
+            after[p].set(p, to_play);
+            if (after[p].clear_captured(p) && after[p].get(p) == to_play)
+                capturing |= 1 << p;
+        }
+        for (pos_t moves : {capturing, pos_t(empty & ~capturing)}) {
+            for (pos_t p = 0; p < size && a < b; p++) {
+                // suicide is illegal
+                if (!(moves & 1 << p) || after[p].get(p).is_empty())
+                    continue;
+                bool repeat = seen(after[p].board);
+                merge(lookups, {{after[p].board, repeat}}, board.board);
+                if (repeat)
+                    continue;
+                path.push_back(after[p].board);
+                child.clear();
+                optional<int> v =
+                    search(after[p], to_play.flip(), State<size>::NORMAL, a, b, child);
+                path.pop_back();
+                if (!visit(v))
+                    return {};
+            }
+        }
+        if (after_pass == State<size>::PASS && a < b && !pass())
+            return {};
+
+        e.used = true;
+        e.given_up = false;
+        e.board = board.board;
+        e.to_play = to_play.value;
+        e.game_state = game_state;
+        e.lower = int8_t(best > alpha ? best : -int(size));
+        e.upper = int8_t(best < beta ? best : int(size));
+        e.lookups = lookups;
+        return best;
+    }
+};
@@ -0,0 +1,188 @@
+#pragma once
+
+#include "lgo.hpp"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <string>
+
+// static evaluators estimate the final score of a state from black's point of view, in the same
+// units as Board::minimax(). they are used where the search has to guess: at the depth cutoff of
+// iterative deepening and for the first MTD(f) guess.
+
+template <pos_t size> struct MinimaxEvaluator {
+    int operator()(const State<size> &state) const { return state.board.minimax(); }
+};
+
+// like Board::score(), but an empty cell between stones of different colors goes to the closer one,
+// or to the player to move if they are equally close
+template <pos_t size> struct InfluenceEvaluator {
+    // returns a board with each cell set to its owner, or left empty if neither
+    static Board<size> influence(const Board<size> &board, Cell to_play) {
+        std::array<pos_t, size> left_dist, right_dist;
+        Board<size> left, right, owner;
+        Cell last = EMPTY;
+        pos_t dist = 0;
+        for (pos_t i = 0; i < size; i++) {
+            if (board.get(i).is_stone())
+                last = board.get(i), dist = 0;
+            left.set(i, last), left_dist[i] = dist++;
+        }
+        last = EMPTY, dist = 0;
+        for (pos_t i = size; i--;) {
+            if (board.get(i).is_stone())
+                last = board.get(i), dist = 0;
+            right.set(i, last), right_dist[i] = dist++;
+        }
+        for (pos_t i = 0; i < size; i++) {
+            Cell l = left.get(i), r = right.get(i);
+            if (l == r || r.is_empty())
+                owner.set(i, l);
+            else if (l.is_empty())
+                owner.set(i, r);
+            else if (left_dist[i] != right_dist[i])
+                owner.set(i, left_dist[i] < right_dist[i] ? l : r);
+            else
+                owner.set(i, to_play);
+        }
+        return owner;
+    }
+    static int count(const Board<size> &owner) {
+        int score = 0;
+        for (pos_t i = 0; i < size; i++)
+            score += (owner.get(i) == BLACK) - (owner.get(i) == WHITE);
+        return score;
+    }
+    int operator()(const State<size> &state) const {
+        return count(influence(state.board, state.to_play));
+    }
+};
+
+// influence, but a chain in atari is given to the opponent when it is the opponent's turn, since
+// it can be captured right away
+template <pos_t size> struct LibertyEvaluator {
+    int operator()(const State<size> &state) const {
+        const Board<size> &board = state.board;
+        Board<size> owner = InfluenceEvaluator<size>::influence(board, state.to_play);
+        for (pos_t i = 0; i < size;) {
+            Cell color = board.get(i);
+            if (!color.is_stone() || color == state.to_play) {
+                i++;
+                continue;
+            }
+            pos_t j = i;
+            while (j < size && board.get(j) == color)
+                j++;
+            bool left_free = i > 0 && board.get(i - 1).is_empty();
+            bool right_free = j < size && board.get(j).is_empty();
+            if (left_free + right_free == 1) {
+                for (pos_t k = i; k < j; k++)
+                    owner.set(k, color.flip());
+                owner.set(left_free ? i - 1 : j, color.flip());
+            }
+            i = j;
+        }
+        return InfluenceEvaluator<size>::count(owner);
+    }
+};
+
+// a linear model with one weight per cell for each pattern of the cell, its two neighbours and the
+// player to move, fitted to solved positions by train_eval.
+template <pos_t size> struct TableEvaluator {
+    static constexpr size_t PATTERNS = 2 << (3 * CELL_WIDTH);
+    static constexpr char MAGIC[4] = {'L', 'G', 'O', 'E'};
+    static constexpr uint32_t VERSION = 1;
+
+    std::array<std::array<float, PATTERNS>, size> weights{};
+    bool loaded = false;
+
+    // off-board neighbours are encoded as CELL_MAX
+    static size_t pattern(const State<size> &state, pos_t i) {
+        size_t key = 0;
+        for (int j = int(i) - 1; j <= int(i) + 1; j++) {
+            pos_t cell = j >= 0 && j < int(size) ? state.board.get(j).value : CELL_MAX;
+            key = key << CELL_WIDTH | cell;
+        }
+        return key << 1 | (state.to_play == WHITE);
+    }
+    float predict(const State<size> &state) const {
+        float sum = 0;
+        for (pos_t i = 0; i < size; i++)
+            sum += weights[i][pattern(state, i)];
+        return sum;
+    }
+    int operator()(const State<size> &state) const {
+        int v = int(std::lround(predict(state)));
+        return std::max(-int(size), std::min(int(size), v));
+    }
+    // one step of stochastic gradient descent on the squared error
+    void train(const State<size> &state, int value, float rate) {
+        float err = predict(state) - value;
+        for (pos_t i = 0; i < size; i++)
+            weights[i][pattern(state, i)] -= rate * err;
+    }
+
+    bool load(const std::string &filename) {
+        std::ifstream in(filename, std::ios::binary);
+        char magic[4];
+        uint32_t version, file_size;
+        if (!in.read(magic, 4) || std::memcmp(magic, MAGIC, 4) != 0)
+            return false;
+        in.read(reinterpret_cast<char *>(&version), sizeof(version));
+        in.read(reinterpret_cast<char *>(&file_size), sizeof(file_size));
+        if (!in || version != VERSION || file_size != size)
+            return false;
+        if (!in.read(reinterpret_cast<char *>(weights.data()), sizeof(weights)))
+            return false;
+        loaded = true;
+        return true;
+    }
+    bool save(const std::string &filename) const {
+        std::ofstream out(filename, std::ios::binary | std::ios::trunc);
+        uint32_t version = VERSION, file_size = size;
+        out.write(MAGIC, 4);
+        out.write(reinterpret_cast<const char *>(&version), sizeof(version));
+        out.write(reinterpret_cast<const char *>(&file_size), sizeof(file_size));
+        out.write(reinterpret_cast<const char *>(weights.data()), sizeof(weights));
+        return bool(out);
+    }
+};
+template <pos_t size> constexpr char TableEvaluator<size>::MAGIC[4];
+
+// picks one of the evaluators above at runtime
+template <pos_t size> struct Evaluator {
+    enum Kind { MINIMAX, INFLUENCE, LIBERTIES, TABLE } kind = MINIMAX;
+    TableEvaluator<size> table;
+
+    // accepts the names used by the ab --eval option
+    bool set_kind(const std::string &name) {
+        if (name == "minimax")
+            kind = MINIMAX;
+        else if (name == "influence")
+            kind = INFLUENCE;
+        else if (name == "liberties")
+            kind = LIBERTIES;
+        else if (name == "table")
+            kind = TABLE;
+        else
+            return false;
+        return true;
+    }
+    int operator()(const State<size> &state) const {
+        switch (kind) {
+        case INFLUENCE:
+            return InfluenceEvaluator<size>()(state);
+        case LIBERTIES:
+            return LibertyEvaluator<size>()(state);
+        case TABLE:
+            if (table.loaded)
+                return table(state);
+            break;
+        case MINIMAX:
+            break;
+        }
+        return MinimaxEvaluator<size>()(state);
+    }
+};
@@ -0,0 +1,36 @@
+#include "cmdparser.hpp"
+#include "gen_book.hpp"
+#include <chrono>
+#include <iostream>
+
+// writes the OpeningBook of a size, for ab --book
+
+constexpr pos_t size = 8;
+
+int main(int argc, char **argv) {
+    cli::Parser parser(argc, argv);
+    parser.set_optional<std::string>("o", "output", "book." + std::to_string(size) + ".bin",
+                                     "File to write the book to");
+    parser.set_optional<int>("d", "plies", 2, "Solve every position up to this many plies");
+    parser.set_optional<int>("j", "threads", std::max(1u, std::thread::hardware_concurrency()),
+                             "Number of threads");
+    parser.run_and_exit_if_error();
+
+    BookBuilder<size> builder;
+    builder.threads = std::max(1, parser.get<int>("j"));
+    auto start = std::chrono::steady_clock::now();
+    builder.progress = [&](size_t solved, size_t positions) {
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        std::cout << "[" << elapsed.count() << "s] solved " << solved << "/" << positions
+                  << std::endl;
+    };
+    OpeningBook<size> book;
+    builder.build(book, std::max(0, parser.get<int>("d")));
+
+    std::string output = parser.get<std::string>("o");
+    if (!book.save(output)) {
+        std::cerr << "failed to write " << output << std::endl;
+        return 1;
+    }
+    std::cout << "wrote " << book.entries.size() << " positions to " << output << std::endl;
+}
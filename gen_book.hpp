@@ -0,0 +1,130 @@
+#pragma once
+
+#include "ab.hpp"
+#include "conjectures.hpp"
+#include <map>
+#include <set>
+#include <thread>
+
+// fills an OpeningBook with the positions up to a number of plies. the positions at the last ply
+// are solved by iterative deepening, shared out among the threads, and the earlier ones are backed
+// up from them by minimax over all their moves, so no search repeats the work of another. a
+// position is visited once, whatever the move order or orientation that reaches it.
+template <pos_t size, typename Impl = conjectures::All<size, PV<size>>> struct BookBuilder {
+    size_t threads = std::max(1u, std::thread::hardware_concurrency());
+    // called after each position of the last ply with the number solved and their total
+    std::function<void(size_t, size_t)> progress;
+
+    void build(OpeningBook<size> &book, size_t plies) {
+        std::vector<State<size>> leaves;
+        std::set<std::pair<uint64_t, size_t>> seen;
+        State<size> root;
+        collect(root, plies, seen, leaves);
+
+        std::vector<std::pair<int, Move>> solved(leaves.size(), {0, Move(EMPTY)});
+        std::atomic<size_t> next{0}, done{0};
+        std::mutex progress_mutex;
+        std::vector<std::thread> pool;
+        for (size_t t = 0; t < std::max<size_t>(threads, 1); t++) {
+            pool.emplace_back([&] {
+                IterativeDeepening<size, AlphaBeta, Impl> ab;
+                ab.verbose = false;
+                for (size_t i; (i = next++) < leaves.size();) {
+                    State<size> &leaf = leaves[i];
+                    int value = ab.search(leaf).minimax;
+                    // the line stops short when the probe of its first move needs a deeper
+                    // cutoff than the search ended with, and then the moves are solved in turn
+                    auto pv = ab.principal_variation(leaf, value);
+                    Move best = pv.empty() ? Move(EMPTY) : pv[0];
+                    for_each_move(leaf, [&](Move m) {
+                        if (best.color != EMPTY)
+                            return;
+                        leaf.play(m);
+                        if ((leaf.terminal() ? leaf.board.minimax() : ab.search(leaf).minimax) ==
+                            value)
+                            best = m;
+                        leaf.undo();
+                    });
+                    solved[i] = {value, best};
+                    std::lock_guard<std::mutex> l(progress_mutex);
+                    if (progress)
+                        progress(++done, leaves.size());
+                }
+            });
+        }
+        for (auto &t : pool)
+            t.join();
+
+        book.entries.clear();
+        for (size_t i = 0; i < leaves.size(); i++)
+            book.add(leaves[i], solved[i].first, solved[i].second);
+        book.sort();
+        OpeningBook<size> earlier;
+        std::map<std::pair<uint64_t, size_t>, int> values;
+        back_up(book, earlier, root, plies, values);
+        book.entries.insert(book.entries.end(), earlier.entries.begin(), earlier.entries.end());
+        book.sort();
+        book.plies = uint32_t(plies);
+    }
+
+  private:
+    // every move, except at the root, where the mirror images and the moves ruled out by the
+    // conjectures are left out as they are by the search
+    template <typename F> static void for_each_move(State<size> &state, F f) {
+        if (state.past.empty()) {
+            std::vector<Move> moves;
+            GoodPlayer<size>(state).moves(state.to_play, moves);
+            for (Move m : moves)
+                f(m);
+            return;
+        }
+        pos_t legal = state.legal_moves(state.to_play);
+        for (pos_t i = 0; i < size; i++)
+            if (legal & (1 << i))
+                f(Move(state.to_play, i));
+        f(Move(state.to_play));
+    }
+
+    // the positions at the last ply. seen holds the keys visited with the plies left.
+    void collect(State<size> &state, size_t plies, std::set<std::pair<uint64_t, size_t>> &seen,
+                 std::vector<State<size>> &leaves) {
+        if (state.terminal())
+            return;
+        if (!seen.emplace(OpeningBook<size>::canonical(state).first, plies).second)
+            return;
+        if (plies == 0) {
+            leaves.push_back(state);
+            return;
+        }
+        for_each_move(state, [&](Move m) {
+            state.play(m);
+            collect(state, plies - 1, seen, leaves);
+            state.undo();
+        });
+    }
+
+    int back_up(const OpeningBook<size> &last, OpeningBook<size> &earlier, State<size> &state,
+                size_t plies, std::map<std::pair<uint64_t, size_t>, int> &values) {
+        if (state.terminal())
+            return state.board.minimax();
+        if (plies == 0)
+            return last.probe(state)->value;
+        auto key = std::make_pair(OpeningBook<size>::canonical(state).first, plies);
+        auto it = values.find(key);
+        if (it != values.end())
+            return it->second;
+        bool black = state.to_play == BLACK;
+        optional<int> best;
+        Move best_move(EMPTY);
+        for_each_move(state, [&](Move m) {
+            state.play(m);
+            int v = back_up(last, earlier, state, plies - 1, values);
+            state.undo();
+            if (!best || (black ? v > *best : v < *best))
+                best = v, best_move = m;
+        });
+        earlier.add(state, *best, best_move);
+        values[key] = *best;
+        return *best;
+    }
+};
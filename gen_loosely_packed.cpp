@@ -8,6 +8,8 @@ constexpr pos_t size = 9;
 int main() {
     auto stable_boards = conjectures::Stability<size, Minimax<size>>::compute_stable_boards();
     using Impl = NewickTree<size, Metrics<size, conjectures::All<size, PV<size>>>>;
+    // one engine for every position, so that they share the transposition table
+    IterativeDeepening<size, AlphaBeta, Impl> ab;
     for (auto board : stable_boards) {
         std::vector<std::pair<pos_t, Move>> moves;
         for (pos_t i = 0; i < size; i++) {
@@ -19,7 +21,6 @@ int main() {
         std::sort(moves.begin(), moves.end(), cmp);
         do {
             for (int i = 0; i < 2; i++) {
-                IterativeDeepening<size, AlphaBeta, Impl> ab;
                 State<size> state;
                 for (auto p : moves) {
                     state.play(p.second);
@@ -0,0 +1,37 @@
+#include "cmdparser.hpp"
+#include "gen_tablebase.hpp"
+#include <chrono>
+#include <iostream>
+
+// writes the Tablebase of a size, for ab --tablebase
+
+constexpr pos_t size = 8;
+
+int main(int argc, char **argv) {
+    cli::Parser parser(argc, argv);
+    parser.set_optional<std::string>("o", "output", "tablebase." + std::to_string(size) + ".bin",
+                                     "File to write the table to");
+    parser.set_optional<int>("e", "empties", size - 2,
+                             "Solve positions with up to this many empty cells");
+    parser.set_optional<int>("j", "threads", std::max(1u, std::thread::hardware_concurrency()),
+                             "Number of threads");
+    parser.run_and_exit_if_error();
+
+    TablebaseGenerator<size> gen;
+    gen.threads = std::max(1, parser.get<int>("j"));
+    auto start = std::chrono::steady_clock::now();
+    gen.progress = [&](pos_t empty, size_t positions, size_t unknown) {
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        std::cout << "[" << elapsed.count() << "s] " << empty << " empty: " << positions
+                  << " positions, " << unknown << " depend on the history" << std::endl;
+    };
+    Tablebase<size> tb;
+    gen.generate(tb, std::max(0, parser.get<int>("e")));
+
+    std::string output = parser.get<std::string>("o");
+    if (!tb.save(output)) {
+        std::cerr << "failed to write " << output << std::endl;
+        return 1;
+    }
+    std::cout << "wrote " << output << std::endl;
+}
@@ -0,0 +1,94 @@
+#pragma once
+
+#include "ab.hpp"
+#include <thread>
+
+// fills a Tablebase in layers by the number of empty cells, fewest first. each position is solved
+// by iterative deepening without conjectures, probing the layers before it. the positions of a
+// layer are independent and shared out among the threads.
+
+// gives up once the search meets a board whose legality depends on the history, since the position
+// is then left unknown. the transposition table is cleared for every position, so a subtree it
+// cuts short has been watched earlier in the same search.
+template <pos_t size> struct HistoryWatch : Minimax<size> {
+    Board<size> root;
+    bool sensitive = false;
+    std::atomic<bool> *stop = nullptr;
+
+    void on_enter(const State<size> &state, int alpha, int beta, size_t depth) {
+        if (!sensitive && Tablebase<size>::reaches_sub_board(state, root))
+            sensitive = *stop = true;
+    }
+};
+
+template <pos_t size> struct TablebaseGenerator {
+    size_t threads = std::max(1u, std::thread::hardware_concurrency());
+    // called after each layer with its number of empty cells, positions and unknown positions
+    std::function<void(pos_t, size_t, size_t)> progress;
+
+    // plays the stones of the position from the empty board, with a pass where one color plays
+    // twice. a state without a past would be taken for the empty board, whose mirror moves are
+    // pruned.
+    static State<size> position(size_t index) {
+        State<size> state;
+        Board<size> board = Tablebase<size>::board(index);
+        for (pos_t p = 0; p < size; p++) {
+            Cell color = board.get(p);
+            if (color.is_empty())
+                continue;
+            if (state.to_play != color)
+                state.play(Move(state.to_play));
+            state.play(Move(color, p));
+        }
+        state.to_play = index % 2 ? WHITE : BLACK;
+        return state;
+    }
+
+    void generate(Tablebase<size> &tb, pos_t max_empty) {
+        max_empty = std::min(max_empty, size);
+        tb.values.assign(2 * tb.boards(), Tablebase<size>::UNKNOWN);
+        std::vector<std::vector<size_t>> layers(size + 1);
+        for (size_t b = 0; b < tb.boards(); b++) {
+            Board<size> board = tb.board(2 * b);
+            if (Tablebase<size>::capture_free(board)) {
+                pos_t empty = __builtin_popcount(board.empty_set());
+                layers[empty].push_back(2 * b);
+                layers[empty].push_back(2 * b + 1);
+            }
+        }
+
+        for (pos_t empty = 0; empty <= max_empty; empty++) {
+            const std::vector<size_t> &layer = layers[empty];
+            std::atomic<size_t> next{0}, unknown{0};
+            std::vector<std::thread> pool;
+            for (size_t t = 0; t < std::max<size_t>(threads, 1); t++) {
+                pool.emplace_back([&] {
+                    IterativeDeepening<size, AlphaBeta, HistoryWatch<size>> ab;
+                    ab.verbose = false;
+                    ab.impl.use_order_table = false;
+                    ab.impl.tablebase = &tb;
+                    // the endgame solver would hide its nodes from the watch
+                    ab.impl.endgame.max_empty = 0;
+                    ab.impl.impl.stop = &ab.limits.stop;
+                    for (size_t i; (i = next++) < layer.size();) {
+                        State<size> state = position(layer[i]);
+                        ab.forget();
+                        ab.impl.impl.root = state.board;
+                        ab.impl.impl.sensitive = ab.limits.stop = false;
+                        auto value = ab.search(state);
+                        // entries of this layer are only read by the layers after it
+                        if (ab.impl.impl.sensitive || !value.exact)
+                            unknown++;
+                        else
+                            tb.values[layer[i]] = int8_t(value.minimax);
+                    }
+                });
+            }
+            for (auto &t : pool)
+                t.join();
+            tb.max_empty = empty;
+            if (progress)
+                progress(empty, layer.size(), unknown);
+        }
+    }
+};
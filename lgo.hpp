@@ -128,6 +128,27 @@ template <pos_t size> struct Board {
             res <<= 1, res |= get(i).is_empty();
         return res;
     }
+    // returns a bitset of empty positions where color would leave an adjacent opponent chain with
+    // a single liberty.
+    pos_t atari_set(Cell color) const {
+        Cell opponent = color.flip();
+        pos_t res = 0;
+        for (pos_t i = 0; i < size; i++) {
+            if (!get(i).is_empty())
+                continue;
+            pos_t t = i + 1;
+            for (; t < size && get(t) == opponent; t++)
+                ;
+            if (t != i + 1 && t < size && get(t).is_empty())
+                res |= 1 << i;
+            pos_t s = i - 1;
+            for (; s < size && get(s) == opponent; s--)
+                ;
+            if (s != i - 1 && s < size && get(s).is_empty())
+                res |= 1 << i;
+        }
+        return res;
+    }
     // remove all stones in range [start, end)
     void clear_chain(pos_t start, pos_t end) {
         assert(start < size);
@@ -208,6 +229,10 @@ template <pos_t size> struct History<size, std::enable_if_t<(size >= 10)>> {
     bool contains(Board<size> s) const { return states.find(s) != states.end(); }
     bool operator==(History h) const { return h.states == states; }
     bool operator!=(History h) const { return h.states != states; }
+    template <typename F> void for_each(F f) const {
+        for (Board<size> s : states)
+            f(s);
+    }
 };
 template <pos_t size> struct History<size, std::enable_if_t<(size < 10)>> {
     std::bitset<1ul << (size * 2)> states;
@@ -216,15 +241,22 @@ template <pos_t size> struct History<size, std::enable_if_t<(size < 10)>> {
     bool contains(Board<size> s) const { return states[s.board]; }
     bool operator==(History h) const { return h.states == states; }
     bool operator!=(History h) const { return h.states != states; }
+    template <typename F> void for_each(F f) const {
+        for (size_t i = states._Find_first(); i < states.size(); i = states._Find_next(i)) {
+            Board<size> s;
+            s.board = pos_t(i);
+            f(s);
+        }
+    }
 };
 
 // Zobrist hashing for states.
 template <pos_t size, typename Hash = size_t> struct ZobristHasher {
     static constexpr size_t MAX_DEPTH = 1000;
     Hash table[MAX_DEPTH][size + 1][CELL_MAX];
+    // a fixed seed keeps hashes, and so transposition table slots, the same across runs
     ZobristHasher() {
-        std::random_device rd;
-        std::mt19937_64 e2(rd());
+        std::mt19937_64 e2(0x9e3779b97f4a7c15);
         std::uniform_int_distribution<Hash> dist;
 
         for (size_t d = 0; d < MAX_DEPTH; d++)
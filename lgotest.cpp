@@ -267,3 +267,22 @@ TEST_CASE("Indirect capture", "[state]") {
     REQUIRE(s.legal_moves(BLACK) == 0b00000);
     REQUIRE(s.legal_moves(WHITE) == 0b01000);
 }
+
+TEST_CASE("Atari moves", "[board]") {
+    Board<6> b;
+    REQUIRE(b.atari_set(BLACK) == 0);
+    b.set(2, WHITE);
+    b.set(3, WHITE);
+    REQUIRE(b.atari_set(BLACK) == 0b010010);
+    REQUIRE(b.atari_set(WHITE) == 0);
+    b.set(5, BLACK);
+    REQUIRE(b.atari_set(BLACK) == 0b010010);
+    // now playing at 4 would capture
+    b.set(1, BLACK);
+    REQUIRE(b.atari_set(BLACK) == 0);
+
+    Board<6> c;
+    c.set(1, BLACK);
+    c.set(2, BLACK);
+    REQUIRE(c.atari_set(WHITE) == 0b001001);
+}
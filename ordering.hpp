@@ -0,0 +1,95 @@
+#pragma once
+
+#include "lgo.hpp"
+#include <array>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <string>
+
+// table of move ordering weights fitted offline by train_ordering. a move is keyed by the cells
+// around it (relative to the player making the move) and whether it captures.
+template <pos_t size> struct OrderingWeights {
+    static constexpr int RADIUS = 2;
+    static constexpr size_t PATTERN_BITS = (2 * RADIUS + 1) * CELL_WIDTH;
+    static constexpr size_t PASS_INDEX = 2 << PATTERN_BITS;
+    static constexpr size_t NUM_ENTRIES = PASS_INDEX + 1;
+    static constexpr char MAGIC[4] = {'L', 'G', 'O', 'W'};
+    static constexpr uint32_t VERSION = 1;
+
+    std::array<int16_t, NUM_ENTRIES> weights{};
+    bool loaded = false;
+
+    // the table used by GoodPlayer, filled at startup by load()
+    static OrderingWeights global;
+
+    // off-board cells are encoded as CELL_MAX, stones as 1 for the mover and 2 for the opponent
+    static size_t index(const Board<size> &board, Move move, bool capturing) {
+        if (move.is_pass)
+            return PASS_INDEX;
+        size_t key = 0;
+        for (int i = -RADIUS; i <= RADIUS; i++) {
+            int pos = int(move.position) + i;
+            pos_t cell = CELL_MAX;
+            if (pos >= 0 && pos < int(size)) {
+                Cell c = board.get(pos);
+                cell = c.is_empty() ? 0 : c == move.color ? 1 : 2;
+            }
+            key = key << CELL_WIDTH | cell;
+        }
+        return key << 1 | capturing;
+    }
+    int weight(const Board<size> &board, Move move, bool capturing) const {
+        return weights[index(board, move, capturing)];
+    }
+
+    bool load(const std::string &filename) {
+        std::ifstream in(filename, std::ios::binary);
+        char magic[4];
+        uint32_t version, file_size, count;
+        if (!in.read(magic, 4) || std::memcmp(magic, MAGIC, 4) != 0)
+            return false;
+        in.read(reinterpret_cast<char *>(&version), sizeof(version));
+        in.read(reinterpret_cast<char *>(&file_size), sizeof(file_size));
+        in.read(reinterpret_cast<char *>(&count), sizeof(count));
+        if (!in || version != VERSION || file_size != size || count != NUM_ENTRIES)
+            return false;
+        if (!in.read(reinterpret_cast<char *>(weights.data()), sizeof(int16_t) * NUM_ENTRIES))
+            return false;
+        loaded = true;
+        return true;
+    }
+    bool save(const std::string &filename) const {
+        std::ofstream out(filename, std::ios::binary | std::ios::trunc);
+        uint32_t version = VERSION, file_size = size, count = NUM_ENTRIES;
+        out.write(MAGIC, 4);
+        out.write(reinterpret_cast<const char *>(&version), sizeof(version));
+        out.write(reinterpret_cast<const char *>(&file_size), sizeof(file_size));
+        out.write(reinterpret_cast<const char *>(&count), sizeof(count));
+        out.write(reinterpret_cast<const char *>(weights.data()), sizeof(int16_t) * NUM_ENTRIES);
+        return bool(out);
+    }
+};
+template <pos_t size> constexpr char OrderingWeights<size>::MAGIC[4];
+template <pos_t size> OrderingWeights<size> OrderingWeights<size>::global;
+
+// accumulates how often each pattern was the best reply versus merely searched, and turns the
+// counts into smoothed log-odds weights.
+template <pos_t size> struct OrderingTrainer {
+    std::array<size_t, OrderingWeights<size>::NUM_ENTRIES> best{}, seen{};
+
+    void observe(const Board<size> &board, Move move, bool capturing, bool is_best) {
+        size_t i = OrderingWeights<size>::index(board, move, capturing);
+        seen[i]++;
+        best[i] += is_best;
+    }
+    OrderingWeights<size> fit() const {
+        OrderingWeights<size> w;
+        for (size_t i = 0; i < w.weights.size(); i++) {
+            double odds = (best[i] + 1.0) / (seen[i] - best[i] + 1.0);
+            w.weights[i] = int16_t(std::lround(std::log(odds) * 1000));
+        }
+        w.loaded = true;
+        return w;
+    }
+};
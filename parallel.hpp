@@ -0,0 +1,280 @@
+#pragma once
+
+#include "ab.hpp"
+#include <deque>
+
+// young brothers wait parallel alpha-beta. near the root the eldest child of a node is searched
+// first, then its younger siblings are pushed onto the worker's deque where idle workers can steal
+// them. a thief replays the moves from the root onto its own state, so superko sees the same
+// history. below split_depth each worker runs a serial AlphaBeta without the order table, whose
+// contents would depend on scheduling. the younger siblings all see the window left by the eldest
+// and are folded into the parent in move order, so the result does not depend on the number of
+// workers or on who searched what.
+template <pos_t size, typename Impl = Minimax<size>> struct ParallelAlphaBeta {
+    typedef typename Impl::return_t return_t;
+    typedef typename Impl::minimax_t minimax_t;
+
+    struct SplitPoint;
+    // a younger sibling, waiting in a deque or being searched
+    struct Task {
+        SplitPoint *sp;
+        size_t index;
+        Move move = Move(EMPTY);
+        CancelToken cancel;
+        optional<return_t> result;
+    };
+    // a node whose younger siblings are searched in parallel
+    struct SplitPoint {
+        std::vector<Move> path; // from the root to the node
+        minimax_t alpha, beta;  // the window left by the eldest child
+        size_t depth;
+        size_t count;
+        std::unique_ptr<Task[]> tasks;
+        std::atomic<size_t> pending;
+    };
+    struct Worker {
+        AlphaBeta<size, Impl> ab;
+        State<size> state;
+        std::vector<Move> path;
+        std::deque<Task *> queue; // the owner takes from the back, thieves from the front
+        std::mutex lock;
+        size_t node_count = 0, steal_count = 0;
+
+        Worker() { ab.use_order_table = false; }
+    };
+
+    size_t threads = std::max(1u, std::thread::hardware_concurrency());
+    size_t split_depth = 4; // nodes this far below the root are searched serially
+    std::vector<std::unique_ptr<Worker>> workers;
+    CancelToken stop; // raise to abandon the search, which then returns an inexact value
+    size_t node_count = 0, steal_count = 0;
+
+    State<size> root;
+    size_t root_depth = 0;
+    std::atomic<bool> done{false};
+
+    return_t search(State<size> &state, minimax_t alpha = Impl::alpha_init(),
+                    minimax_t beta = Impl::beta_init(), size_t depth = 0) {
+        while (workers.size() < threads)
+            workers.emplace_back(std::make_unique<Worker>());
+        root = state;
+        root_depth = depth;
+        for (auto &w : workers) {
+            w->state = state;
+            w->path.clear();
+            w->ab.node_count = w->node_count = w->steal_count = 0;
+        }
+        done = false;
+        std::vector<std::thread> pool;
+        for (size_t i = 1; i < threads; i++)
+            pool.emplace_back([this, i] { work(*workers[i]); });
+        return_t result = split(*workers[0], alpha, beta, depth, &stop);
+        done = true;
+        for (auto &t : pool)
+            t.join();
+
+        node_count = steal_count = 0;
+        for (auto &w : workers) {
+            node_count += w->node_count + w->ab.node_count;
+            steal_count += w->steal_count;
+        }
+        return result;
+    }
+
+    void work(Worker &w) {
+        while (!done) {
+            if (Task *task = steal(w))
+                run(w, *task, true);
+            else
+                std::this_thread::yield();
+        }
+    }
+
+    Task *steal(Worker &thief) {
+        for (auto &victim : workers) {
+            if (victim.get() == &thief)
+                continue;
+            std::lock_guard<std::mutex> l(victim->lock);
+            if (!victim->queue.empty()) {
+                Task *task = victim->queue.front();
+                victim->queue.pop_front();
+                thief.steal_count++;
+                return task;
+            }
+        }
+        return nullptr;
+    }
+
+    // the earliest of the split point's tasks still in the worker's own deque. they sit at the
+    // back, above any tasks of enclosing split points.
+    Task *take_own(Worker &w, const SplitPoint &sp) {
+        std::lock_guard<std::mutex> l(w.lock);
+        auto it = w.queue.end();
+        while (it != w.queue.begin() && (*std::prev(it))->sp == &sp)
+            --it;
+        if (it == w.queue.end())
+            return nullptr;
+        Task *task = *it;
+        w.queue.erase(it);
+        return task;
+    }
+
+    static bool cuts(Move move, const return_t &child, minimax_t alpha, minimax_t beta) {
+        return child.exact &&
+               (move.color == BLACK ? child.minimax >= beta : child.minimax <= alpha);
+    }
+
+    // a stolen task is replayed from the root, the owner's state is already at the split point
+    void run(Worker &w, Task &task, bool stolen) {
+        SplitPoint &sp = *task.sp;
+        if (!task.cancel.cancelled()) {
+            if (stolen) {
+                w.state = root;
+                for (Move m : sp.path)
+                    w.state.play(m);
+                w.path = sp.path;
+            }
+            w.state.play(task.move);
+            w.path.push_back(task.move);
+            task.result = split(w, sp.alpha, sp.beta, sp.depth + 1, &task.cancel);
+            w.state.undo();
+            w.path.pop_back();
+            // a cutoff makes the younger siblings redundant, the older ones are still needed to
+            // fold the siblings in order
+            if (cuts(task.move, *task.result, sp.alpha, sp.beta))
+                for (size_t i = task.index + 1; i < sp.count; i++)
+                    sp.tasks[i].cancel.flag = true;
+        }
+        sp.pending--;
+    }
+
+    // the body of AlphaBeta::search_window for a wide window, with the younger siblings searched
+    // in parallel. the root is always split.
+    return_t split(Worker &w, minimax_t alpha, minimax_t beta, size_t depth,
+                   const CancelToken *cancel) {
+        if (depth >= root_depth + std::max<size_t>(split_depth, 1)) {
+            w.ab.cancel = cancel;
+            return w.ab.search(w.state, alpha, beta, depth);
+        }
+        State<size> &state = w.state;
+        Impl &impl = w.ab.impl;
+        const minimax_t ab = alpha, bb = beta;
+        w.node_count++;
+        bool terminal = false;
+
+        // passing sets bounds
+        if (state.game_state == State<size>::PASS) {
+            int minimax = state.board.minimax();
+            if (state.to_play == BLACK)
+                alpha = std::max(alpha, minimax);
+            if (state.to_play == WHITE)
+                beta = std::min(beta, minimax);
+        }
+
+        auto parent = impl.init_node(state, alpha, beta, depth, terminal);
+        if (cancel->cancelled()) {
+            parent.exact = false;
+            terminal = true;
+        } else if (!terminal) {
+            int lower = StaticBounds<size>::lower(state.board);
+            if (lower >= beta) {
+                parent.minimax = lower;
+                terminal = true;
+            } else {
+                int upper = StaticBounds<size>::upper(state.board);
+                if (upper <= alpha) {
+                    parent.minimax = upper;
+                    terminal = true;
+                }
+            }
+        }
+        if (terminal) {
+            parent.type = AlphaBeta<size, Impl>::template node_type<false>(parent.minimax, ab, bb);
+            impl.on_exit(state, alpha, beta, depth, parent, true);
+            return parent;
+        }
+        impl.on_enter(state, alpha, beta, depth);
+
+        bool all_exact = true;
+        auto parent_inexact = parent;
+        // returns whether the search of the remaining children stops
+        auto fold = [&](Move move, const return_t &child) {
+            all_exact &= child.exact;
+            if (cancel->cancelled()) {
+                all_exact = false;
+                return true;
+            }
+            if (child.exact)
+                impl.update(move, alpha, beta, parent, child);
+            auto alpha_inexact = alpha;
+            auto beta_inexact = beta;
+            impl.update(move, alpha_inexact, beta_inexact, parent_inexact, child);
+            if (beta <= alpha && child.exact) {
+                all_exact = parent.exact;
+                return true;
+            }
+            return false;
+        };
+
+        std::vector<Move> moves;
+        moves.reserve(size + 1);
+        if (beta > alpha) {
+            impl.gen_moves(state, moves);
+            impl.pre_update(moves[0], alpha, beta, parent, depth, 0);
+            state.play(moves[0]);
+            w.path.push_back(moves[0]);
+            auto eldest = split(w, alpha, beta, depth + 1, cancel);
+            state.undo();
+            w.path.pop_back();
+
+            if (!fold(moves[0], eldest) && moves.size() > 1) {
+                SplitPoint sp;
+                sp.path = w.path;
+                sp.alpha = alpha;
+                sp.beta = beta;
+                sp.depth = depth;
+                sp.count = moves.size() - 1;
+                sp.tasks = std::make_unique<Task[]>(sp.count);
+                sp.pending = sp.count;
+                for (size_t i = 0; i < sp.count; i++) {
+                    sp.tasks[i].sp = &sp;
+                    sp.tasks[i].index = i;
+                    sp.tasks[i].move = moves[i + 1];
+                    sp.tasks[i].cancel.parent = cancel;
+                }
+                {
+                    std::lock_guard<std::mutex> l(w.lock);
+                    for (size_t i = 0; i < sp.count; i++)
+                        w.queue.push_back(&sp.tasks[i]);
+                }
+                // search our own siblings until the rest have been stolen, then wait for them
+                while (sp.pending) {
+                    if (Task *task = take_own(w, sp))
+                        run(w, *task, false);
+                    else
+                        std::this_thread::yield();
+                }
+                for (size_t i = 0; i < sp.count; i++) {
+                    Task &task = sp.tasks[i];
+                    impl.pre_update(task.move, alpha, beta, parent, depth, i + 1);
+                    // only cancelled tasks have no result
+                    if (!task.result) {
+                        all_exact = false;
+                        break;
+                    }
+                    if (fold(task.move, *task.result))
+                        break;
+                }
+            }
+        }
+        parent.exact = all_exact;
+        if (!parent.exact) {
+            parent_inexact.exact = all_exact;
+            parent = parent_inexact;
+        }
+
+        parent.type = AlphaBeta<size, Impl>::template node_type<false>(parent.minimax, ab, bb);
+        impl.on_exit(state, alpha, beta, depth, parent, false);
+        return parent;
+    }
+};
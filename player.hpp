@@ -1,6 +1,7 @@
 #pragma once
 
 #include "lgo.hpp"
+#include "ordering.hpp"
 #include <algorithm>
 
 template <pos_t size> struct GoodPlayer {
@@ -83,6 +84,36 @@ template <pos_t size> struct GoodPlayer {
         if (legal & (1 << (size - 1)))
             moves.emplace_back(color, size - 1);
     }
+    // reorder generated moves by the offline trained weights, breaking ties by the change in
+    // minimax and then by the order the rules above produced them in
+    void ordered_moves(Cell color, std::vector<Move>::iterator first,
+                       std::vector<Move> &moves) const {
+        const OrderingWeights<size> &weights = OrderingWeights<size>::global;
+        if (!weights.loaded)
+            return;
+        int scbefore = state.board.minimax();
+        int sign = color == BLACK ? 1 : -1;
+        pos_t capturing = state.capturing_moves(color);
+        std::vector<std::tuple<int, int, Move>> ms;
+        for (auto it = first; it != moves.end(); it++) {
+            Move m = *it;
+            Board<size> b = state.board;
+            bool captures = false;
+            if (!m.is_pass) {
+                captures = capturing & (1 << m.position);
+                b.set(m.position, m.color);
+                b.clear_captured(m.position);
+            }
+            int delta = sign * (b.minimax() - scbefore);
+            ms.emplace_back(weights.weight(state.board, m, captures), delta, m);
+        }
+        std::stable_sort(ms.begin(), ms.end(), [](const auto &a, const auto &b) {
+            return std::get<0>(a) == std::get<0>(b) ? std::get<1>(a) > std::get<1>(b)
+                                                    : std::get<0>(a) > std::get<0>(b);
+        });
+        for (auto &m : ms)
+            *first++ = std::get<2>(m);
+    }
     void moves(Cell color, std::vector<Move> &moves) const {
         pos_t legal = state.legal_moves(color);
 
@@ -120,6 +151,7 @@ template <pos_t size> struct GoodPlayer {
             }
         }
 
+        size_t generated = moves.size();
         if (!has_pass)
             moves.emplace_back(color);
 
@@ -128,27 +160,6 @@ template <pos_t size> struct GoodPlayer {
         atari_moves(color, legal, moves);
         //safe_moves(color, legal, moves);
         other_moves(color, legal, moves);
-        /*
-        int scbefore = state.board.minimax();
-        std::vector<std::pair<int, Move>> ms;
-        const std::vector<int> weights{-1,2,1,1,1,1,2,-1};
-        for (size_t i = 0; i < moves.size(); i++) {
-            Move &m = moves[i];
-            Board<size> b = state.board;
-            if (!m.is_pass) {
-                b.set(m.position, m.color);
-                b.clear_captured(m.position);
-            }
-            int score = b.minimax();
-            score = score - scbefore;
-            if (!m.is_pass)
-                score += weights[m.position];
-            score += moves.size() - i;
-            ms.emplace_back(score, m);
-        }
-        std::sort(ms.begin(), ms.end(), [](const std::pair<int, Move> &a, const std::pair<int, Move> &b) { return a.first > b.first; });
-        for (size_t i = 0; i < moves.size(); i++) {
-            moves[i] = ms[i].second;
-        }*/
+        ordered_moves(color, moves.begin() + generated, moves);
     }
 };
@@ -0,0 +1,126 @@
+#pragma once
+
+#include "lgo.hpp"
+#include <climits>
+#include <cstring>
+#include <fstream>
+#include <string>
+
+// exact values of positions which have had no capture yet, probed by the searches as terminal
+// nodes. until the first capture every move adds a stone, so the boards seen so far are all
+// sub-boards of the current one, and they only come into play if captures later lead back to one
+// of them. the value of a position is stored when its search never met such a board, and then
+// holds whatever order the stones were played in. the others, most of the positions with few empty
+// cells, are left unknown. on size 5, 34 of the 165 capture-free positions reached in play have a
+// value which depends on the order.
+//
+// gen_tablebase fills the table bottom up, from the fewest empty cells to the most, so that every
+// search can probe the positions below it.
+template <pos_t size> struct Tablebase {
+    static constexpr char MAGIC[4] = {'L', 'G', 'O', 'T'};
+    static constexpr uint32_t VERSION = 1;
+    static constexpr int8_t UNKNOWN = INT8_MIN;
+
+    static constexpr size_t boards() {
+        size_t n = 1;
+        for (pos_t i = 0; i < size; i++)
+            n *= 3;
+        return n;
+    }
+
+    std::vector<int8_t> values; // by index(), empty if there is no table
+    uint32_t max_empty = 0;     // positions with more empty cells are unknown
+
+    // the board read as a number in base 3, with the player to move as the lowest digit
+    static size_t index(const Board<size> &board, Cell to_play) {
+        size_t i = 0;
+        for (pos_t p = size; p--;)
+            i = i * 3 + board.get(p).value;
+        return i * 2 + (to_play == WHITE);
+    }
+    static Board<size> board(size_t index) {
+        Board<size> b;
+        index /= 2;
+        for (pos_t p = 0; p < size; p++, index /= 3)
+            b.set(p, Cell(index % 3));
+        return b;
+    }
+
+    // the position has had no capture and is not after a pass
+    optional<int> probe(const State<size> &state) const {
+        if (values.empty() || state.board.captured || state.game_state != State<size>::NORMAL)
+            return {};
+        int8_t v = values[index(state.board, state.to_play)];
+        if (v == UNKNOWN)
+            return {};
+        return int(v);
+    }
+
+    // a board can be reached without captures iff every chain has a liberty, and then in any order
+    static bool capture_free(const Board<size> &board) {
+        for (pos_t i = 0; i < size;) {
+            if (board.get(i).is_empty()) {
+                i++;
+                continue;
+            }
+            pos_t j = i;
+            while (j < size && board.get(j) == board.get(i))
+                j++;
+            if (!(i > 0 && board.get(i - 1).is_empty()) && !(j < size && board.get(j).is_empty()))
+                return false;
+            i = j;
+        }
+        return true;
+    }
+    static bool sub_board(const Board<size> &b, const Board<size> &root) {
+        for (pos_t p = 0; p < size; p++)
+            if (b.get(p).is_stone() && b.get(p) != root.get(p))
+                return false;
+        return true;
+    }
+    // whether the player to move has a move at state to a board strictly below root, which may or
+    // may not have been seen on the way to root
+    static bool reaches_sub_board(const State<size> &state, const Board<size> &root) {
+        Cell color = state.to_play;
+        for (pos_t p = 0; p < size; p++) {
+            if (!state.board.get(p).is_empty() || root.get(p) != color)
+                continue;
+            Board<size> b = state.board;
+            b.set(p, color);
+            b.clear_captured(p);
+            if (b.get(p) == color && b != root && sub_board(b, root))
+                return true;
+        }
+        return false;
+    }
+
+    bool load(const std::string &filename) {
+        std::ifstream in(filename, std::ios::binary);
+        char magic[4];
+        uint32_t version, file_size, file_max_empty;
+        if (!in.read(magic, 4) || std::memcmp(magic, MAGIC, 4) != 0)
+            return false;
+        in.read(reinterpret_cast<char *>(&version), sizeof(version));
+        in.read(reinterpret_cast<char *>(&file_size), sizeof(file_size));
+        in.read(reinterpret_cast<char *>(&file_max_empty), sizeof(file_max_empty));
+        if (!in || version != VERSION || file_size != size)
+            return false;
+        std::vector<int8_t> v(2 * boards());
+        if (!in.read(reinterpret_cast<char *>(v.data()), v.size()))
+            return false;
+        values = std::move(v);
+        max_empty = file_max_empty;
+        return true;
+    }
+    bool save(const std::string &filename) const {
+        std::ofstream out(filename, std::ios::binary | std::ios::trunc);
+        uint32_t version = VERSION, file_size = size;
+        out.write(MAGIC, 4);
+        out.write(reinterpret_cast<const char *>(&version), sizeof(version));
+        out.write(reinterpret_cast<const char *>(&file_size), sizeof(file_size));
+        out.write(reinterpret_cast<const char *>(&max_empty), sizeof(max_empty));
+        out.write(reinterpret_cast<const char *>(values.data()), values.size());
+        return bool(out);
+    }
+};
+template <pos_t size> constexpr char Tablebase<size>::MAGIC[4];
@@ -0,0 +1,87 @@
+#include "cmdparser.hpp"
+#include "evaluate.hpp"
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+// fits a TableEvaluator to solved positions, given one per line in the format written by
+// gen_loosely_packed: moves like b3 w5, an optional F to flip the player to move, then the value.
+
+constexpr pos_t size = 9;
+
+struct Sample {
+    State<size> state;
+    int value;
+};
+
+bool parse_sample(const std::string &line, std::vector<Sample> &samples) {
+    State<size> state;
+    std::istringstream iss(line);
+    std::string token;
+    while (iss >> token) {
+        char c = tolower(token[0]);
+        if (c == 'b' || c == 'w') {
+            Cell color = c == 'b' ? BLACK : WHITE;
+            pos_t pos = std::stoi(token.substr(1)) - 1;
+            if (pos >= size || !(state.legal_moves(color) & (1 << pos)))
+                return false;
+            state.play(Move(color, pos));
+        } else if (c == 'f') {
+            state.to_play = state.to_play.flip();
+        } else {
+            samples.push_back(Sample{state, std::stoi(token)});
+            return true;
+        }
+    }
+    return false;
+}
+
+int main(int argc, char **argv) {
+    cli::Parser parser(argc, argv);
+    parser.set_optional<std::string>("o", "output", "eval." + std::to_string(size) + ".bin",
+                                     "File to write the fitted table to");
+    parser.set_optional<int>("e", "epochs", 50, "Passes of gradient descent over the samples");
+    parser.set_optional<double>("r", "rate", 0.01, "Learning rate");
+    parser.set_required<std::vector<std::string>>("", "solved", "Files of solved positions");
+    parser.run_and_exit_if_error();
+
+    std::vector<Sample> samples;
+    for (const std::string &filename : parser.get<std::vector<std::string>>("")) {
+        std::ifstream in(filename);
+        std::string line;
+        size_t skipped = 0;
+        while (std::getline(in, line)) {
+            try {
+                skipped += !parse_sample(line, samples);
+            } catch (std::exception &) {
+                skipped++;
+            }
+        }
+        if (skipped)
+            std::cerr << filename << ": skipped " << skipped << " lines" << std::endl;
+    }
+    if (samples.empty()) {
+        std::cerr << "no solved positions found for size " << size << std::endl;
+        return 1;
+    }
+
+    TableEvaluator<size> table;
+    float rate = parser.get<double>("r");
+    for (int epoch = 0; epoch < parser.get<int>("e"); epoch++) {
+        double error = 0;
+        for (const Sample &s : samples) {
+            float diff = table.predict(s.state) - s.value;
+            error += diff * diff;
+            table.train(s.state, s.value, rate);
+        }
+        std::cout << "epoch " << epoch << " rms error " << std::sqrt(error / samples.size())
+                  << std::endl;
+    }
+
+    std::string output = parser.get<std::string>("o");
+    if (!table.save(output)) {
+        std::cerr << "failed to write " << output << std::endl;
+        return 1;
+    }
+    std::cout << "wrote " << output << " from " << samples.size() << " positions" << std::endl;
+}
@@ -0,0 +1,167 @@
+#include "cmdparser.hpp"
+#include "ordering.hpp"
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <sstream>
+
+// fits move ordering weights from searchtree.*.nhx dumps written by NewickTree. every internal
+// node with a recorded to_play contributes one sample per exact child, labelling the first child
+// which attained the best value for the player to move.
+
+constexpr pos_t size = 9;
+
+struct TreeNode {
+    std::string name;
+    int minimax = 0;
+    bool exact = false;
+    Cell to_play = EMPTY;
+    std::vector<std::unique_ptr<TreeNode>> children;
+};
+
+struct NewickParser {
+    std::string text;
+    size_t pos = 0;
+
+    std::unique_ptr<TreeNode> parse_node() {
+        auto node = std::make_unique<TreeNode>();
+        if (text[pos] == '(') {
+            do {
+                pos++;
+                node->children.emplace_back(parse_node());
+            } while (text[pos] == ',');
+            if (text[pos++] != ')')
+                throw std::runtime_error("expected ')'");
+        }
+        while (pos < text.size() && text[pos] != '[' && text[pos] != ',' && text[pos] != ')' &&
+               text[pos] != ';')
+            node->name += text[pos++];
+        if (pos < text.size() && text[pos] == '[') {
+            size_t end = text.find(']', pos);
+            if (end == std::string::npos)
+                throw std::runtime_error("unterminated attributes");
+            std::istringstream attrs(text.substr(pos + 1, end - pos - 1));
+            std::string attr;
+            while (std::getline(attrs, attr, ':')) {
+                size_t eq = attr.find('=');
+                if (eq == std::string::npos)
+                    continue;
+                std::string key = attr.substr(0, eq), value = attr.substr(eq + 1);
+                if (key == "minimax")
+                    node->minimax = std::stoi(value);
+                else if (key == "exact")
+                    node->exact = value == "1";
+                else if (key == "to_play")
+                    node->to_play = value == "B" ? BLACK : value == "W" ? WHITE : EMPTY;
+            }
+            pos = end + 1;
+        }
+        return node;
+    }
+};
+
+optional<Board<size>> parse_board(const std::string &name) {
+    if (name.size() != size)
+        return {};
+    Board<size> board;
+    for (pos_t i = 0; i < size; i++) {
+        if (name[i] == 'B')
+            board.set(i, BLACK);
+        else if (name[i] == 'W')
+            board.set(i, WHITE);
+        else if (name[i] != '.')
+            return {};
+    }
+    return board;
+}
+
+// recover the move leading from parent to child: the cell that the mover newly occupies, or a
+// pass if the board did not change
+optional<Move> find_move(Board<size> parent, Board<size> child, Cell color) {
+    if (parent == child)
+        return Move(color);
+    for (pos_t i = 0; i < size; i++) {
+        if (parent.get(i).is_empty() && child.get(i) == color) {
+            Board<size> b = parent;
+            b.set(i, color);
+            b.clear_captured(i);
+            if (b == child)
+                return Move(color, i);
+        }
+    }
+    return {};
+}
+
+size_t train(const TreeNode &node, OrderingTrainer<size> &trainer) {
+    size_t samples = 0;
+    for (auto &child : node.children)
+        samples += train(*child, trainer);
+    optional<Board<size>> parent = parse_board(node.name);
+    if (!parent || !node.to_play.is_stone() || node.children.empty())
+        return samples;
+
+    std::vector<std::pair<Move, int>> replies;
+    for (auto &child : node.children) {
+        optional<Board<size>> b = parse_board(child->name);
+        if (!child->exact || !b)
+            continue;
+        if (optional<Move> m = find_move(*parent, *b, node.to_play))
+            replies.emplace_back(*m, child->minimax);
+    }
+    if (replies.empty())
+        return samples;
+    size_t best = 0;
+    for (size_t i = 1; i < replies.size(); i++) {
+        int diff = replies[i].second - replies[best].second;
+        if (node.to_play == BLACK ? diff > 0 : diff < 0)
+            best = i;
+    }
+    // captures are recomputed from the parent board since the dump does not record history
+    for (size_t i = 0; i < replies.size(); i++) {
+        Move m = replies[i].first;
+        bool capturing = false;
+        if (!m.is_pass) {
+            Board<size> b = *parent;
+            b.set(m.position, m.color);
+            capturing = b.clear_captured(m.position) != 0 && b.get(m.position) == m.color;
+        }
+        trainer.observe(*parent, m, capturing, i == best);
+        samples++;
+    }
+    return samples;
+}
+
+int main(int argc, char **argv) {
+    cli::Parser parser(argc, argv);
+    parser.set_optional<std::string>("o", "output", "ordering." + std::to_string(size) + ".bin",
+                                     "File to write the fitted weights to");
+    parser.set_required<std::vector<std::string>>("", "trees", "searchtree.*.nhx files to train on");
+    parser.run_and_exit_if_error();
+
+    OrderingTrainer<size> trainer;
+    size_t samples = 0;
+    for (const std::string &filename : parser.get<std::vector<std::string>>("")) {
+        std::ifstream in(filename);
+        std::stringstream ss;
+        ss << in.rdbuf();
+        NewickParser p{ss.str()};
+        try {
+            auto root = p.parse_node();
+            size_t n = train(*root, trainer);
+            std::cout << filename << ": " << n << " samples" << std::endl;
+            samples += n;
+        } catch (std::exception &e) {
+            std::cerr << filename << ": " << e.what() << std::endl;
+        }
+    }
+    if (samples == 0) {
+        std::cerr << "no samples found for size " << size << std::endl;
+        return 1;
+    }
+    std::string output = parser.get<std::string>("o");
+    if (!trainer.fit().save(output)) {
+        std::cerr << "failed to write " << output << std::endl;
+        return 1;
+    }
+    std::cout << "wrote " << output << " from " << samples << " samples" << std::endl;
+}